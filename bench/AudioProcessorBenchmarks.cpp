@@ -0,0 +1,220 @@
+#include <soundstone/AudioProcessor.hpp>
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <vector>
+#include <memory>
+
+using namespace soundstone;
+using namespace std;
+
+namespace {
+
+    /**
+     * Sums its inputs through a one-pole filter, so every module costs about the same and produces the same
+     * samples on every run.
+     */
+    class FilterModule : public Module {
+        uint32_t _input_count;
+        float _state = 0.0f;
+        bool _was_sampled = false;
+
+    public:
+        explicit FilterModule(uint32_t input_count) : _input_count(input_count) {}
+
+        bool was_sampled() const {
+            return _was_sampled;
+        }
+
+        uint32_t input_count() const override {
+            return _input_count;
+        }
+
+        void commit() override {}
+
+        void sample(const float *const *input_buffers, float *output_buffer, uint32_t nsamples) override {
+            float state = _state;
+            for (uint32_t i = 0; i < nsamples; ++i) {
+                float sum = 0.001f * static_cast<float>(i);
+                for (uint32_t input = 0; input < _input_count; ++input) {
+                    sum += input_buffers[input][i];
+                }
+                state = state * 0.99f + sum * 0.01f;
+                output_buffer[i] = state;
+            }
+            _state = state;
+            _was_sampled = true;
+        }
+    };
+
+    /**
+     * A graph of filter modules, where each module is added with the modules feeding each of its inputs.
+     */
+    class SyntheticGraph {
+        vector<unique_ptr<FilterModule>> _modules;
+        vector<vector<uint32_t>> _inputs;
+
+    public:
+        uint32_t add(vector<uint32_t> inputs) {
+            _modules.emplace_back(new FilterModule(static_cast<uint32_t>(inputs.size())));
+            _inputs.emplace_back(move(inputs));
+            return static_cast<uint32_t>(_modules.size() - 1);
+        }
+
+        uint32_t size() const {
+            return static_cast<uint32_t>(_modules.size());
+        }
+
+        /**
+         * @brief change_count The number of changes setup queues, which the processor needs room for.
+         */
+        uint32_t change_count() const {
+            uint32_t count = size();
+            for (const vector<uint32_t> &inputs : _inputs) {
+                count += static_cast<uint32_t>(inputs.size());
+            }
+            return count;
+        }
+
+        /**
+         * @brief setup Add every module and route to the processor, and wait for them to be built.
+         * @return False if the processor had no room left for a change.
+         */
+        bool setup(AudioProcessor &processor) {
+            for (auto &module : _modules) {
+                if (!processor.add_module(module.get())) {
+                    return false;
+                }
+            }
+            for (uint32_t i = 0, ilen = size(); i < ilen; ++i) {
+                for (uint32_t input = 0, jlen = static_cast<uint32_t>(_inputs[i].size()); input < jlen; ++input) {
+                    if (!processor.route(_modules[_inputs[i][input]].get()).to(_modules[i].get(), input)) {
+                        return false;
+                    }
+                }
+            }
+            processor.wait_for_changes();
+            return true;
+        }
+
+        /**
+         * @brief sampled_count The number of modules which have been sampled at least once.
+         */
+        uint32_t sampled_count() const {
+            uint32_t count = 0;
+            for (const auto &module : _modules) {
+                count += module->was_sampled() ? 1 : 0;
+            }
+            return count;
+        }
+    };
+
+    // Every other module mixed straight into one output.
+    void build_wide(SyntheticGraph &graph, uint32_t module_count) {
+        vector<uint32_t> voices;
+        for (uint32_t i = 1; i < module_count; ++i) {
+            voices.push_back(graph.add({}));
+        }
+        graph.add(voices);
+    }
+
+    // One long chain of effects.
+    void build_deep(SyntheticGraph &graph, uint32_t module_count) {
+        uint32_t node = graph.add({});
+        while (graph.size() < module_count) {
+            node = graph.add({node});
+        }
+    }
+
+    // A chain of diamonds, each splitting into two branches which are joined again.
+    void build_diamonds(SyntheticGraph &graph, uint32_t module_count) {
+        uint32_t node = graph.add({});
+        while (graph.size() + 3 <= module_count) {
+            uint32_t left = graph.add({node});
+            uint32_t right = graph.add({node});
+            node = graph.add({left, right});
+        }
+        while (graph.size() < module_count) {
+            node = graph.add({node});
+        }
+    }
+
+    // Each module reads from up to four earlier modules, picked by a fixed linear congruential generator so the
+    // graph is the same on every platform and every run.
+    void build_random(SyntheticGraph &graph, uint32_t module_count) {
+        uint32_t seed = 12345;
+        auto next = [&seed] {
+            seed = seed * 1664525u + 1013904223u;
+            return seed >> 8;
+        };
+
+        graph.add({});
+        while (graph.size() < module_count) {
+            uint32_t input_count = next() % 5;
+            vector<uint32_t> inputs;
+            for (uint32_t i = 0; i < input_count; ++i) {
+                inputs.push_back(next() % graph.size());
+            }
+            graph.add(inputs);
+        }
+    }
+
+    void run(benchmark::State &state, void (*build)(SyntheticGraph &, uint32_t)) {
+        uint32_t module_count = static_cast<uint32_t>(state.range(0));
+        uint32_t block_size = static_cast<uint32_t>(state.range(1));
+        uint32_t thread_count = static_cast<uint32_t>(state.range(2));
+
+        SyntheticGraph graph;
+        build(graph, module_count);
+
+        // Leave room to queue the whole graph at once, as changes which don't fit are dropped.
+        AudioProcessor processor(max(graph.change_count(), AudioProcessor::DEFAULT_ACTION_CAPACITY));
+        processor.set_block_size(block_size);
+        processor.set_thread_count(thread_count);
+        if (!graph.setup(processor)) {
+            state.SkipWithError("The processor dropped a change to the graph");
+            return;
+        }
+
+        // Make sure the whole graph is being run before timing it.
+        processor.update(block_size);
+        if (graph.sampled_count() != graph.size() || processor.cyclic_route_count() != 0) {
+            state.SkipWithError("The processor didn't build the whole graph");
+            return;
+        }
+
+        for (auto _ : state) {
+            processor.update(block_size);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * block_size);
+    }
+}
+
+static void BM_AudioProcessorWideGraph(benchmark::State &state) {
+    run(state, build_wide);
+}
+
+static void BM_AudioProcessorDeepGraph(benchmark::State &state) {
+    run(state, build_deep);
+}
+
+static void BM_AudioProcessorDiamondGraph(benchmark::State &state) {
+    run(state, build_diamonds);
+}
+
+static void BM_AudioProcessorRandomGraph(benchmark::State &state) {
+    run(state, build_random);
+}
+
+// Arguments are module count, block size and thread count. Items processed are frames.
+static void graph_arguments(benchmark::internal::Benchmark *benchmark) {
+    benchmark
+        ->ArgsProduct({{10, 100, 1000, 10000}, {64, 256, 1024}, {1, 2, 4}})
+        ->ArgNames({"modules", "block", "threads"})
+        ->UseRealTime();
+}
+
+BENCHMARK(BM_AudioProcessorWideGraph)->Apply(graph_arguments);
+BENCHMARK(BM_AudioProcessorDeepGraph)->Apply(graph_arguments);
+BENCHMARK(BM_AudioProcessorDiamondGraph)->Apply(graph_arguments);
+BENCHMARK(BM_AudioProcessorRandomGraph)->Apply(graph_arguments);
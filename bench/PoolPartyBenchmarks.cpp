@@ -0,0 +1,140 @@
+#include <soundstone/PoolParty.hpp>
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <memory>
+
+using namespace soundstone;
+using namespace std;
+
+namespace {
+
+    const uint32_t BUFFER_LENGTH = 256;
+
+    /**
+     * A graph of tasks that each filter a buffer of samples from their dependencies, similar to a module graph.
+     */
+    class SyntheticGraph {
+        vector<unique_ptr<float[]>> _buffers;
+        vector<vector<uint32_t>> _dependencies;
+
+    public:
+        uint32_t add(vector<uint32_t> dependencies) {
+            _buffers.emplace_back(new float[BUFFER_LENGTH]());
+            _dependencies.emplace_back(move(dependencies));
+            return _buffers.size() - 1;
+        }
+
+        void setup(PoolParty &party) {
+            for (uint32_t i = 0, ilen = _buffers.size(); i < ilen; ++i) {
+                float *output = _buffers[i].get();
+                vector<const float *> inputs;
+                for (uint32_t dependency : _dependencies[i]) {
+                    inputs.push_back(_buffers[dependency].get());
+                }
+
+                party.add_work([output, inputs]{
+                    float state = output[BUFFER_LENGTH - 1];
+                    for (uint32_t j = 0; j < BUFFER_LENGTH; ++j) {
+                        float sum = 0.001f * j;
+                        for (const float *input : inputs) {
+                            sum += input[j];
+                        }
+                        state = state * 0.99f + sum * 0.01f;
+                        output[j] = state;
+                    }
+                    benchmark::ClobberMemory();
+                }, _dependencies[i].data(), _dependencies[i].size());
+            }
+        }
+    };
+
+    // Many independent voices mixed into one output.
+    void build_wide(SyntheticGraph &graph, uint32_t voice_count) {
+        vector<uint32_t> voices;
+        for (uint32_t i = 0; i < voice_count; ++i) {
+            voices.push_back(graph.add({}));
+        }
+        graph.add(voices);
+    }
+
+    // A few voices, each through a long chain of effects, mixed into one output.
+    void build_deep(SyntheticGraph &graph, uint32_t chain_count, uint32_t chain_length) {
+        vector<uint32_t> chain_ends;
+        for (uint32_t i = 0; i < chain_count; ++i) {
+            uint32_t node = graph.add({});
+            for (uint32_t j = 1; j < chain_length; ++j) {
+                node = graph.add({node});
+            }
+            chain_ends.push_back(node);
+        }
+        graph.add(chain_ends);
+    }
+
+    void run(benchmark::State &state, SyntheticGraph &graph) {
+        PoolParty party;
+        party.set_scheduler(static_cast<PoolParty::Scheduler>(state.range(1)));
+        // The thread calling work counts as one of the threads.
+        party.setup(static_cast<uint32_t>(state.range(0)) - 1);
+        graph.setup(party);
+
+        for (auto _ : state) {
+            party.work();
+        }
+    }
+}
+
+static void BM_PoolPartyWideGraph(benchmark::State &state) {
+    SyntheticGraph graph;
+    build_wide(graph, 512);
+    run(state, graph);
+}
+
+static void BM_PoolPartyDeepGraph(benchmark::State &state) {
+    SyntheticGraph graph;
+    build_deep(graph, 4, 128);
+    run(state, graph);
+}
+
+// Tasks which do nothing, so only the cost of handing them out and waiting for them is measured.
+static void BM_PoolPartyEmptyTasks(benchmark::State &state) {
+    PoolParty party;
+    party.set_scheduler(static_cast<PoolParty::Scheduler>(state.range(1)));
+    party.setup(static_cast<uint32_t>(state.range(0)) - 1);
+
+    uint32_t task_count = static_cast<uint32_t>(state.range(2));
+    for (uint32_t i = 0; i < task_count; ++i) {
+        party.add_work([]{});
+    }
+
+    for (auto _ : state) {
+        party.work();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * task_count);
+}
+
+// Arguments are thread count and scheduler.
+BENCHMARK(BM_PoolPartyWideGraph)
+    ->ArgsProduct({{1, 2, 4, 8, 16, 32}, {
+        static_cast<int64_t>(PoolParty::Scheduler::SHARED),
+        static_cast<int64_t>(PoolParty::Scheduler::WORK_STEALING)
+    }})
+    ->ArgNames({"threads", "scheduler"})
+    ->UseRealTime();
+
+BENCHMARK(BM_PoolPartyDeepGraph)
+    ->ArgsProduct({{1, 2, 4, 8, 16, 32}, {
+        static_cast<int64_t>(PoolParty::Scheduler::SHARED),
+        static_cast<int64_t>(PoolParty::Scheduler::WORK_STEALING)
+    }})
+    ->ArgNames({"threads", "scheduler"})
+    ->UseRealTime();
+
+// Arguments are thread count, scheduler and task count. Items processed are tasks.
+BENCHMARK(BM_PoolPartyEmptyTasks)
+    ->ArgsProduct({{1, 2, 4, 8}, {
+        static_cast<int64_t>(PoolParty::Scheduler::SHARED),
+        static_cast<int64_t>(PoolParty::Scheduler::WORK_STEALING)
+    }, {16, 256, 4096}})
+    ->ArgNames({"threads", "scheduler", "tasks"})
+    ->UseRealTime();
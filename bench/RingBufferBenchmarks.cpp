@@ -0,0 +1,50 @@
+#include <soundstone/RingBuffer.hpp>
+#include <soundstone/SpscRingBuffer.hpp>
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace soundstone;
+using namespace std;
+
+namespace {
+    const size_t CAPACITY = 1 << 16;
+}
+
+// Argument is the number of samples produced and consumed at a time.
+static void BM_RingBufferProduceConsume(benchmark::State &state) {
+    size_t chunk_size = static_cast<size_t>(state.range(0));
+    vector<float> input(chunk_size, 1.0f);
+    vector<float> output(chunk_size);
+
+    RingBuffer<float> buffer;
+    buffer.reserve(CAPACITY);
+    // Start part way through, so chunks wrap around the end of the buffer.
+    buffer.produce(input.data(), chunk_size / 2);
+
+    for (auto _ : state) {
+        buffer.produce(input.data(), chunk_size);
+        buffer.consume(output.data(), chunk_size);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * chunk_size * sizeof(float)));
+}
+
+static void BM_SpscRingBufferProduceConsume(benchmark::State &state) {
+    size_t chunk_size = static_cast<size_t>(state.range(0));
+    vector<float> input(chunk_size, 1.0f);
+    vector<float> output(chunk_size);
+
+    SpscRingBuffer<float> buffer(CAPACITY);
+    buffer.produce(input.data(), chunk_size / 2);
+
+    for (auto _ : state) {
+        buffer.produce(input.data(), chunk_size);
+        buffer.consume(output.data(), chunk_size);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * chunk_size * sizeof(float)));
+}
+
+BENCHMARK(BM_RingBufferProduceConsume)->RangeMultiplier(4)->Range(16, 16384)->ArgName("chunk");
+BENCHMARK(BM_SpscRingBufferProduceConsume)->RangeMultiplier(4)->Range(16, 16384)->ArgName("chunk");
@@ -1,14 +1,21 @@
 #include "Mixer.hpp"
+#include <soundstone/simd/Kernels.hpp>
 
 using namespace soundstone_example;
 using namespace soundstone;
 
+uint32_t Mixer::input_count() const {
+    return 2;
+}
+
+bool Mixer::preserves_silence() const {
+    return true;
+}
+
 void Mixer::commit() {
 
 }
 
 void Mixer::sample(const float *const *input_buffers, float *output_buffer, uint32_t nsamples) {
-    for (uint32_t i = 0; i < nsamples; ++i) {
-        output_buffer[i] = (input_buffers[0][i] + input_buffers[1][i]);
-    }
+    simd::sum(input_buffers, 2, output_buffer, nsamples);
 }
@@ -5,6 +5,8 @@ namespace soundstone_example {
 
     class Mixer : public soundstone::Module {
 
+        bool preserves_silence() const override;
+        uint32_t input_count() const override;
         void commit() override;
         void sample(const float *const *input_buffers, float *output_buffer, uint32_t nsamples) override;
 
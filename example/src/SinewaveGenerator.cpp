@@ -1,4 +1,6 @@
 #include "SinewaveGenerator.hpp"
+#include <soundstone/simd/Kernels.hpp>
+#include <algorithm>
 #include <cmath>
 
 using namespace soundstone_example;
@@ -16,6 +18,10 @@ SinewaveGenerator::SinewaveGenerator(uint32_t frequency, uint32_t sample_rate) {
     }
 }
 
+uint32_t SinewaveGenerator::input_count() const {
+    return 0;
+}
+
 void SinewaveGenerator::commit() {
 
 }
@@ -25,10 +31,14 @@ void SinewaveGenerator::sample(
     float *output_data,
     uint32_t nsamples
 ) {
-    for (size_t i = 0; i < nsamples; ++i) {
-        output_data[i] = _samples[_i] * _amplitude;
-        _i = (_i + 1) % _samples_per_cycle;
+    // Copy whole runs of the cycle, then scale them all at once.
+    for (uint32_t i = 0; i < nsamples;) {
+        uint32_t run = min(nsamples - i, _samples_per_cycle - _i);
+        copy_n(&_samples[_i], run, output_data + i);
+        i += run;
+        _i = (_i + run) % _samples_per_cycle;
     }
+    simd::gain_ramp(output_data, _amplitude, _amplitude, output_data, nsamples);
 }
 
 void SinewaveGenerator::set_amplitude(float amplitude) {
@@ -13,6 +13,7 @@ namespace soundstone_example {
         // Module methods
         //
 
+        uint32_t input_count() const override;
         void commit() override;
         void sample(const float * const *input_data, float *output_data, uint32_t nsamples) override;
 
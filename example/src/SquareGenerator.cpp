@@ -9,6 +9,10 @@ SquareGenerator::SquareGenerator(float frequency, uint32_t sample_rate) {
     _samples_per_cycle = static_cast<uint32_t>(sample_rate / _frequency);
 }
 
+uint32_t SquareGenerator::input_count() const {
+    return 0;
+}
+
 void SquareGenerator::commit() {
 
 }
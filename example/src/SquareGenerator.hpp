@@ -15,6 +15,7 @@ namespace soundstone_example {
         // Module functions
         //
 
+        uint32_t input_count() const override;
         void commit() override;
         void sample(const float * const *input_buffers, float *output_data, uint32_t nsamples) override;
 
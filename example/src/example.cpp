@@ -6,11 +6,16 @@
 #include <soundstone/AudioProcessor.hpp>
 #include <soundstone/SystemOutputModule.hpp>
 #include <soundstone/ThreadedDriver.hpp>
+#include <soundstone/CallbackDriver.hpp>
+#include <soundstone/OfflineDriver.hpp>
+#include <soundstone/FileOutputModule.hpp>
+#include <soundstone/ThreadConfig.hpp>
 
 #include <thread>
 #include <iostream>
 #include <chrono>
 #include <cmath>
+#include <string>
 
 
 #pragma clang diagnostic push
@@ -23,9 +28,56 @@ using namespace std;
 using namespace std::chrono;
 
 
+// Render ten seconds to a WAV file as fast as possible, without opening the audio device.
+int render_to_file(const string &path) {
+    const uint32_t sample_rate = 48000;
+
+    AudioFileWriter writer;
+    if (!writer.open(path, AudioFileWriter::Format::WAV, 2, sample_rate)) {
+        cerr << "Couldn't open " << path << endl;
+        return 1;
+    }
+
+    AudioProcessor processor;
+    FileOutputModule output(&writer);
+    SinewaveGenerator sin(540, sample_rate);
+    SquareGenerator square(540, sample_rate);
+    square.set_amplitude(0.25f);
+    Mixer mixer;
+
+    processor.add_module(&output);
+    processor.add_module(&sin);
+    processor.add_module(&square);
+    processor.add_module(&mixer);
+
+    processor.route(&sin).to(&mixer, 0);
+    processor.route(&square).to(&mixer, 1);
+    processor.route(&mixer).to(&output);
+
+    OfflineDriver driver(&processor, sample_rate);
+    OfflineDriver::Report report = driver.render_for(seconds(10));
+    if (!writer.close()) {
+        cerr << "Couldn't write " << path << endl;
+        return 1;
+    }
+
+    cout << "Rendered " << report.frame_count << " frames to " << path << " in "
+         << duration_cast<milliseconds>(report.elapsed).count() << "ms, "
+         << report.realtime_factor() << "x realtime" << endl;
+    return 0;
+}
+
+
 int main(int argc, char **argv) {
+    if (argc > 2 && string(argv[1]) == "--render") {
+        return render_to_file(argv[2]);
+    }
+
+    // Render from inside the device callback rather than queuing ahead on a thread of our own.
+    bool use_callback_driver = argc > 1 && string(argv[1]) == "--callback";
+
     AudioProcessor processor;
-    SystemAudio system;
+    SystemAudio system(2);
 
     SystemOutputModule output(&system);
     SinewaveGenerator sin(540, system.sample_rate());
@@ -44,23 +96,46 @@ int main(int argc, char **argv) {
 
     processor.set_thread_count(1);
 
-    uint32_t underflows = 0;
-
-    system.set_drained_callback([&]{ ++underflows; });
+    // Ask for realtime scheduling, which quietly doesn't happen without the privileges for it.
+    ThreadConfig thread_config;
+    thread_config.policy = ThreadConfig::Policy::FIFO;
+    thread_config.priority = 10;
+    thread_config.prefault_stack_bytes = 64 * 1024;
+    thread_config.flush_denormals = true;
+    processor.set_thread_config(thread_config);
 
     const uint32_t driver_latency = 512;
+    const uint32_t driver_low_water = 256;
 
     cout << "=== Soundstone Example ===" << endl;
     cout << "Sample Rate: " << system.sample_rate() << endl;
     cout << "System Audio Latency: " << system.latency() << endl;
-    cout << "Driver Latency: " << driver_latency << endl;
 
-    ThreadedDriver driver(&processor, &system);
-    driver.set_latency_samples(driver_latency);
-    driver.start();
+    ThreadedDriver threaded_driver(&processor, &system);
+    CallbackDriver callback_driver(&processor, &system, &output);
+    if (use_callback_driver) {
+        cout << "Driver: Callback" << endl;
+        callback_driver.set_thread_config(thread_config);
+        callback_driver.start();
+    } else {
+        cout << "Driver Latency: " << driver_latency << " (wakes at " << driver_low_water << ")" << endl;
+        threaded_driver.set_latency_samples(driver_latency);
+        threaded_driver.set_low_water_samples(driver_low_water);
+        threaded_driver.set_thread_config(thread_config);
+        threaded_driver.start();
+
+        ThreadConfig::Report report = threaded_driver.thread_config_report();
+        cout << "Driver Thread: realtime priority " << (report.priority ? "on" : "off")
+             << ", denormals " << (report.denormals_flushed ? "flushed" : "kept") << endl;
+    }
 
     while (true) {
-        cout << "\r" << "Samples Buffered: " << system.samples_buffered() << ", Underflows: " << underflows;
+        SystemAudio::Telemetry telemetry = system.telemetry();
+        cout << "\r" << "Samples Buffered: " << system.samples_buffered()
+             << " (" << telemetry.min_buffered_frames << "-" << telemetry.max_buffered_frames << ")"
+             << ", Underflows: " << telemetry.underflow_count
+             << ", Callback p99: " << duration_cast<microseconds>(telemetry.callback_duration.p99).count() << "us"
+             << ", Jitter p99: " << duration_cast<microseconds>(telemetry.period_jitter.p99).count() << "us   ";
         cout.flush();
         this_thread::sleep_for(milliseconds(250));
     }
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <soundstone/testable_export.h>
+
+namespace soundstone {
+
+    /**
+     * One contiguous block of zeroed floats, carved into aligned, padded buffers. Buffers are reserved first, as
+     * offsets, and the whole block is allocated at once when everything has been reserved.
+     */
+    class SOUNDSTONE_TESTABLE_EXPORT AlignedArena {
+        std::unique_ptr<char[]> _memory;
+        float *_data = nullptr;
+        size_t _size = 0;
+
+    public:
+        // Every buffer starts on a boundary of this many bytes, and is padded to a whole number of them.
+        static const size_t ALIGNMENT = 64;
+        static const size_t FLOATS_PER_ALIGNMENT = ALIGNMENT / sizeof(float);
+
+        AlignedArena() = default;
+        AlignedArena(const AlignedArena &) = delete;
+        AlignedArena &operator=(const AlignedArena &) = delete;
+
+        /**
+         * @brief reserve Reserve room for a buffer. Must not be called after allocate.
+         * @return The offset of the buffer, to be passed to at once the arena is allocated.
+         */
+        size_t reserve(size_t float_count);
+
+        /**
+         * @brief allocate Allocate room for every buffer reserved so far, with every float set to zero.
+         */
+        void allocate();
+
+        float *at(size_t offset) const;
+
+        /**
+         * @brief size The number of floats reserved, including padding.
+         */
+        size_t size() const;
+    };
+}
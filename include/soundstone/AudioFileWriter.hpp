@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <soundstone/export.h>
+
+namespace soundstone {
+    /**
+     * Writes 32-bit float samples to a file, either as a WAV file or as raw little-endian interleaved frames.
+     * Frames are gathered into a buffer of its own and written out in large blocks, so many small writes cost little.
+     */
+    class SOUNDSTONE_EXPORT AudioFileWriter final {
+    public:
+        enum class Format {
+            WAV,
+            RAW
+        };
+
+        // Frames gathered before they are written out.
+        static const uint32_t BUFFER_FRAMES = 16384;
+
+    private:
+        std::FILE *_file = nullptr;
+        Format _format = Format::WAV;
+        uint32_t _channel_count = 0;
+        uint32_t _sample_rate = 0;
+        uint64_t _frame_count = 0;
+        bool _has_failed = false;
+
+        std::unique_ptr<float[]> _buffer;
+        uint32_t _buffered_frame_count = 0;
+
+        void flush();
+        void write_header();
+
+    public:
+        AudioFileWriter() = default;
+        AudioFileWriter(const AudioFileWriter &) = delete;
+        AudioFileWriter &operator=(const AudioFileWriter &) = delete;
+        ~AudioFileWriter();
+
+        /**
+         * @brief open Create or truncate the file at path, closing any file already open.
+         * @return false if the file couldn't be created.
+         */
+        bool open(const std::string &path, Format format, uint32_t channel_count, uint32_t sample_rate);
+
+        /**
+         * @brief close Write out anything buffered and, for WAV files, the final sizes in the header.
+         * @return false if any write to the file failed since it was opened.
+         */
+        bool close();
+
+        /**
+         * @brief write Append interleaved frames. Does nothing when no file is open.
+         */
+        void write(const float *frames, uint32_t frame_count);
+
+        /**
+         * @brief write_planar Append planar frames, each channel being stride samples after the last.
+         */
+        void write_planar(const float *planar, uint32_t stride, uint32_t frame_count);
+
+        bool is_open() const;
+        uint32_t channel_count() const;
+        uint32_t sample_rate() const;
+
+        /**
+         * @brief frame_count The number of frames written since the file was opened, including buffered ones.
+         */
+        uint64_t frame_count() const;
+    };
+}
@@ -2,16 +2,23 @@
 #include "Module.hpp"
 #include "SamplerWorker.hpp"
 #include "DependencyGraph.hpp"
+#include "BufferLiveness.hpp"
+#include "AlignedArena.hpp"
 #include "PoolParty.hpp"
+#include "MpscQueue.hpp"
+#include "TimingWindow.hpp"
 #include <soundstone/RingBuffer.hpp>
 #include <soundstone/export.h>
 
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <unordered_set>
 #include <unordered_map>
 #include <array>
+#include <memory>
 
 
 namespace soundstone {
@@ -24,22 +31,94 @@ namespace soundstone {
             Module *_source = nullptr;
         public:
             RoutePredicate(AudioProcessor *processor, Module *source);
-            void to(Module *destination, uint32_t index = 0);
+            bool to(Module *destination, uint32_t index = 0);
+            bool mix_into(Module *destination, uint32_t index = 0, float gain = 1.0f);
         };
 
     private:
-        static const uint32_t MAX_MODULE_INPUTS = 16;
+        class Route {
+        public:
+            Module *source = nullptr;
+            float gain = 1.0f;
+        };
 
         class ModuleHarness {
         public:
             Module *module = nullptr;
-            std::array<Module *, MAX_MODULE_INPUTS> inputs {};
+            // One slot per input the module declares, each summing any number of routes.
+            std::vector<std::vector<Route>> inputs;
+            // Only kept when built with SOUNDSTONE_MODULE_STATS.
+            std::shared_ptr<TimingWindow> timing;
+            // The measured cost the current snapshot was prioritized with in nanoseconds, 0 if it had none yet.
+            uint64_t scheduled_cost = 0;
+        };
+
+        /**
+         * A module as it is run by the execution plan. Input and output buffers are resolved when the plan is
+         * compiled, so running a node requires no lookups.
+         */
+        class PlanNode {
+        public:
+            class MixSource {
+            public:
+                const float *buffer = nullptr;
+                uint32_t channel_count = 0;
+                float gain = 1.0f;
+                const bool *is_silent = nullptr;
+            };
+
+            /**
+             * An input which can't read straight from its source's output: several sources summed together, a gain
+             * to apply, or a different number of channels than the input expects. The sources are mixed into a
+             * buffer of the node's own before the module is sampled.
+             */
+            class InputMix {
+            public:
+                float *destination = nullptr;
+                uint32_t destination_channel_count = 0;
+                std::vector<MixSource> sources;
+            };
+
+            /**
+             * A route from another node into an input, whose silence has to be looked up every block. Unrouted
+             * inputs are always silent and are never looked at again. Routes into the same input are consecutive.
+             */
+            class RoutedInput {
+            public:
+                uint32_t index = 0;
+                bool is_first_into_input = true;
+                const bool *source_is_silent = nullptr;
+            };
+
+            Module *module = nullptr;
+            float *output = nullptr;
+            uint32_t channel_count = 1;
+
+            // Slices of the snapshot's input lists. Every declared input has a buffer and silence flag, while only
+            // routed inputs have to be visited each block.
+            const float **inputs = nullptr;
+            bool *silent_inputs = nullptr;
+            uint32_t input_count = 0;
+            const RoutedInput *routed_inputs = nullptr;
+            uint32_t routed_input_count = 0;
+
+            // Whether the output of the last block was silent, read by nodes downstream.
+            bool output_is_silent = false;
+            bool preserves_silence = false;
+
+            std::vector<InputMix> mixes;
+            std::vector<uint32_t> dependencies;
+
+            // Kept alive by the snapshot, so the node can still be timed after its module has been removed.
+            std::shared_ptr<TimingWindow> timing;
         };
 
         enum class ActionType {
             ADD_MODULE,
             REMOVE_MODULE,
-            ROUTE_MODULE
+            ROUTE_MODULE,
+            MIX_MODULE,
+            UNMIX_MODULE
         };
 
         class AddRemoveData {
@@ -52,50 +131,246 @@ namespace soundstone {
             Module *source = nullptr;
             Module *dest = nullptr;
             uint32_t index = 0;
+            float gain = 1.0f;
         };
 
         union ActionData {
             AddRemoveData add_remove;
             RouteData route;
+
+            ActionData() : add_remove() {}
         };
 
         class Action {
         public:
-            ActionType type;
+            ActionType type = ActionType::ADD_MODULE;
             ActionData data;
         };
 
+        /**
+         * Everything the audio thread needs to run the graph. Snapshots are built on the builder thread and handed to
+         * the audio thread whole, so changing the graph costs the audio thread a single pointer swap. Nothing in a
+         * published snapshot changes apart from the number of samples being processed and the state of each block,
+         * like which outputs are silent.
+         */
+        class Snapshot {
+        public:
+            // Modules in topological order, with work for each node added to the work set in the same order.
+            std::vector<PlanNode> plan;
+            PoolParty::WorkSet work;
+
+            // The inputs of every node, one after the other, so modules with many inputs cost no more to set up
+            // than the same number of modules with one.
+            std::vector<const float *> input_buffers;
+            std::unique_ptr<bool[]> silent_inputs;
+            std::vector<PlanNode::RoutedInput> routed_inputs;
+
+            // Every buffer of the snapshot: output buffers, shared between modules whose outputs are never needed at
+            // the same time, buffers for converted inputs, and the null buffer read by unrouted inputs. Each holds
+            // block_size samples for every channel.
+            AlignedArena arena;
+            const float *null_buffer = nullptr;
+            uint32_t block_size = 0;
+
+            // Snapshots built for a single thread share buffers on the assumption that nodes run in plan order,
+            // which the pool party doesn't keep to, so they're run by the thread calling update instead.
+            bool runs_in_plan_order = false;
+
+            uint32_t nsamples = 0;
+
+            Snapshot *next_retired = nullptr;
+        };
+
+        // Graph state, only touched by the builder thread.
         std::vector<ModuleHarness> _harnesses;
         std::unordered_map<Module *, uint32_t> _modules_to_harnesses;
+        DependencyGraph<Module *> _graph;
+        std::vector<std::vector<uint32_t>> _plan_dependencies;
+        BufferLiveness _buffer_liveness;
 
-        std::vector<std::unique_ptr<float[]>> _sampler_buffers;
-        std::vector<std::array<const float *, MAX_MODULE_INPUTS>> _input_vectors;
-        std::unique_ptr<float[]> _null_sample_buffer;
-        uint32_t _sampler_buffer_length = 0;
+        // The newest snapshot not yet picked up by the audio thread.
+        std::atomic<Snapshot *> _pending_snapshot {nullptr};
+        // Snapshots the audio thread is done with, waiting for the builder thread to delete them.
+        std::atomic<Snapshot *> _retired_snapshots {nullptr};
 
-        std::vector<std::pair<std::unique_ptr<uint32_t[]>, uint32_t>> _dependency_indices;
-        bool _dependency_indices_are_dirty = true;
+        // Audio thread state. The previous snapshot is kept until the pool party has run the current one, as workers
+        // late to leave the last call may still be looking at it until then.
+        Snapshot *_snapshot = nullptr;
+        Snapshot *_previous_snapshot = nullptr;
 
+        // Setting up the party restarts its threads, so it's done holding the party mutex, which update only ever
+        // tries to take. The thread count, wait policy and thread config are changed along with it.
         PoolParty _party;
+        mutable std::mutex _party_mutex;
+        std::atomic<uint32_t> _thread_count {1};
+        std::atomic<uint32_t> _block_size {DEFAULT_BLOCK_SIZE};
+        std::atomic<PoolParty::Scheduler> _scheduler {PoolParty::Scheduler::SHARED};
+        PoolParty::WaitPolicy _wait_policy;
+        ThreadConfig _thread_config;
+
+        // Changes to the graph, queued from any thread and applied by the builder thread.
+        MpscQueue<Action> _actions;
+
+        // The builder thread sleeps until the epoch changes, which happens whenever there's something new to build.
+        std::thread _builder_thread;
+        std::mutex _builder_mutex;
+        std::condition_variable _builder_condition;
+        std::atomic<uint32_t> _builder_epoch {0};
+        std::atomic<bool> _builder_is_waiting {false};
+        std::atomic<bool> _builder_should_quit {false};
 
-        std::queue<Action> _actions;
-        std::mutex _actions_mutex;
+        // What the last published snapshot was built from. Guarded by the builder mutex.
+        std::condition_variable _built_condition;
+        size_t _built_action_count = 0;
+        uint32_t _built_thread_count = 0;
+        uint32_t _built_block_size = 0;
+        PoolParty::Scheduler _built_scheduler = PoolParty::Scheduler::SHARED;
 
+        // The timing of every added module, looked up by module_stats. Guarded by the timings mutex, as the builder
+        // thread adds and removes them.
+        std::unordered_map<Module *, std::shared_ptr<TimingWindow>> _timings;
+        mutable std::mutex _timings_mutex;
 
-        void process_actions();
+        // Routes dropped by the builder thread because they would have created a cycle.
+        std::atomic<uint64_t> _cyclic_route_count {0};
+
+        bool queue_action(const Action &action);
+        void wake_builder();
+        void builder_routine();
+        bool process_actions();
         void process_add(AddRemoveData data);
         void process_remove(AddRemoveData data);
         void process_route(RouteData data);
+        void process_mix(RouteData data);
+        void process_unmix(RouteData data);
+        bool can_route(const RouteData &data, ModuleHarness *&harness);
+        bool creates_cycle(const RouteData &data);
+        void remove_unused_dependency(ModuleHarness &harness, Module *source);
+        static void run_mix(const PlanNode::InputMix &mix, uint32_t nsamples);
+        Snapshot *build_snapshot(uint32_t thread_count, uint32_t block_size, PoolParty::Scheduler scheduler);
+        void measure_costs(const std::vector<uint32_t> &order, std::vector<uint64_t> &costs);
+        bool costs_have_drifted() const;
+        void publish_snapshot(Snapshot *snapshot);
+        void retire_snapshot(Snapshot *snapshot);
+        void delete_retired_snapshots();
+        static void sample_node(PlanNode &node, uint32_t nsamples);
+        static void run_node(PlanNode &node, uint32_t nsamples);
 
 
     public:
-        void add_module(Module *module);
-        void remove_module(Module *module);
+        static const uint32_t DEFAULT_ACTION_CAPACITY = 4096;
+        static const uint32_t DEFAULT_BLOCK_SIZE = 256;
+
+        /**
+         * @param action_capacity The number of graph changes which can be queued before the builder thread gets to
+         *                        them.
+         */
+        explicit AudioProcessor(uint32_t action_capacity = DEFAULT_ACTION_CAPACITY);
+        ~AudioProcessor();
+
+        /**
+         * Graph changes are queued without blocking, and a new snapshot of the graph is built from them on a
+         * background thread. The update after the snapshot is ready uses it. Each returns false if the queue is full,
+         * in which case the change is dropped.
+         *
+         * A removed module may still be sampled until the change has been picked up, so call wait_for_changes and
+         * then update before destroying it.
+         */
+        bool add_module(Module *module);
+        bool remove_module(Module *module);
 
-        void set_input(Module *module, uint32_t index, Module *input);
+        /**
+         * Routes to an input past the module's input_count are ignored when the change is built. So are routes which
+         * would create a cycle, like routing a module into itself or into a module it is already routed from. Those
+         * can only be found once the change is built, so they still return true, and are counted by
+         * cyclic_route_count instead.
+         *
+         * set_input replaces everything routed to an input with a single module, or nothing if input is null.
+         */
+        bool set_input(Module *module, uint32_t index, Module *input);
+
+        /**
+         * @brief mix_input Add a module to the ones summed into an input, or change its gain if it already is.
+         *                  Summing and gain are done by the processor, so mixing needs no modules of its own.
+         */
+        bool mix_input(Module *module, uint32_t index, Module *input, float gain = 1.0f);
+        bool unmix_input(Module *module, uint32_t index, Module *input);
         RoutePredicate route(Module *module);
 
+        /**
+         * @brief cyclic_route_count The number of routes dropped so far because they would have created a cycle.
+         *                           Routes queued before a call to wait_for_changes are counted once it returns.
+         */
+        uint64_t cyclic_route_count() const;
+
+        /**
+         * @brief wait_for_changes Block until every change queued so far has been built, so the next update uses it.
+         *                         Must not be called from the audio thread.
+         */
+        void wait_for_changes();
+
+        /**
+         * @brief update Sample every module. Updates for more samples than the block size are processed in several
+         *               blocks, so modules are never sampled for more than the block size at once.
+         */
         void update(uint32_t nsamples);
+
+        /**
+         * @brief set_thread_count Set the number of threads modules are sampled on, including the thread calling
+         *                         update. Waits for the graph to be rebuilt for the new thread count.
+         *
+         * set_thread_count, set_wait_policy and set_thread_config restart the processing threads. They may be called
+         * while another thread is updating, which they wait for. Updates that start while the threads are restarting
+         * don't wait, and instead sample every module on the thread calling update.
+         */
         void set_thread_count(uint32_t count);
+
+        /**
+         * @brief thread_count The number of threads modules are sampled on, as last set by set_thread_count.
+         */
+        uint32_t thread_count() const;
+
+        /**
+         * @brief set_block_size Set the most samples modules are sampled for at once. Buffers are allocated for this
+         *                       many samples when the graph is built, so small blocks keep them in cache, while larger
+         *                       ones have less overhead per sample. Rounded up to a multiple of Module::BUFFER_PADDING.
+         *                       Waits for the graph to be rebuilt for the new size.
+         */
+        void set_block_size(uint32_t block_size);
+
+        /**
+         * @brief set_wait_policy Set how long idle processing threads busy wait and yield before sleeping.
+         */
+        void set_wait_policy(const PoolParty::WaitPolicy &policy);
+
+        /**
+         * @brief set_thread_config Set up the processing threads, restarting them to apply it. The thread calling
+         *                          update is left alone, so apply the config to it too.
+         */
+        void set_thread_config(const ThreadConfig &config);
+
+        /**
+         * @brief thread_config_reports What took effect on each processing thread, not counting the one calling
+         *                              update.
+         */
+        std::vector<ThreadConfig::Report> thread_config_reports() const;
+
+        /**
+         * @brief set_scheduler Choose how modules are handed out to threads. Safe to call while another thread is
+         *                      updating, as it takes effect with the next snapshot of the graph.
+         *
+         * Modules on the longest path through the graph are handed out first. Only builds with SOUNDSTONE_MODULE_STATS
+         * time modules, so by default every module counts the same, and the longest path is the one with the most
+         * modules on it.
+         */
+        void set_scheduler(PoolParty::Scheduler scheduler);
+
+        /**
+         * @brief module_stats How long a module has taken to sample, including mixing its inputs, over the last
+         *                     TimingWindow::CAPACITY blocks. Never blocks the audio thread. Modules are only timed
+         *                     when built with SOUNDSTONE_MODULE_STATS, which otherwise compiles the timing out.
+         * @return false if the module hasn't been added, or modules aren't timed.
+         */
+        bool module_stats(Module *module, TimingWindow::Summary &stats) const;
     };
 }
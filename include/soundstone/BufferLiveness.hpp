@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <soundstone/testable_export.h>
+
+namespace soundstone {
+
+    /**
+     * Assigns output buffers to the nodes of a topologically ordered graph, so that nodes whose outputs are never
+     * needed at the same time share a buffer. A buffer is recycled once every node reading from it has run.
+     */
+    class SOUNDSTONE_TESTABLE_EXPORT BufferLiveness {
+    public:
+        enum class Mode {
+            // Nodes run one at a time in order. A buffer is free as soon as the last node reading it has run.
+            SEQUENTIAL,
+            // Nodes may run concurrently in any order their dependencies allow. A buffer is only handed to a node
+            // which depends, directly or through other nodes, on every node reading the buffer's previous contents.
+            CONCURRENT
+        };
+
+    private:
+        class Buffer {
+        public:
+            // Nodes which must all have run before the buffer can be written again.
+            std::vector<uint32_t> readers;
+        };
+
+        std::vector<Buffer> _buffers;
+        std::vector<std::vector<uint32_t>> _dependents;
+
+        // Bit sets of the nodes each node depends on, directly or through other nodes.
+        std::vector<uint64_t> _ancestors;
+        uint32_t _ancestor_words = 0;
+
+        void build_dependents(const std::vector<std::vector<uint32_t>> &dependencies);
+        void assign_sequential(std::vector<uint32_t> &buffer_indices);
+        void assign_concurrent(
+            const std::vector<std::vector<uint32_t>> &dependencies, std::vector<uint32_t> &buffer_indices
+        );
+        bool is_ancestor(uint32_t node, uint32_t ancestor) const;
+
+    public:
+        /**
+         * @brief assign Assign an output buffer to every node.
+         * @param dependencies   For each node, the nodes whose output it reads. Nodes must be in topological order,
+         *                       so every dependency has a lower index than the node depending on it.
+         * @param mode           How the nodes are going to be run.
+         * @param buffer_indices Set to the buffer assigned to each node.
+         * @return The number of buffers needed.
+         */
+        uint32_t assign(
+            const std::vector<std::vector<uint32_t>> &dependencies, Mode mode, std::vector<uint32_t> &buffer_indices
+        );
+    };
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "AudioProcessor.hpp"
+#include "SystemAudio.hpp"
+#include "SystemOutputModule.hpp"
+#include "ThreadConfig.hpp"
+
+namespace soundstone {
+    /**
+     * Runs the processor from inside the device callback, for exactly as many frames as the device asks for, with
+     * the output module interleaving straight into the device's buffer. Nothing is queued, so there is no latency
+     * beyond the device's own, but the whole graph has to be processed within one device period.
+     *
+     * The processor must run on a single thread. With more, update waits on locks for the other processing threads
+     * to finish their work, which the device's thread must never do. Use a ThreadedDriver to process on more threads.
+     *
+     * Don't use together with a ThreadedDriver on the same system audio.
+     */
+    class CallbackDriver final : public SystemAudio::Renderer {
+
+        AudioProcessor *_processor = nullptr;
+        SystemAudio *_system = nullptr;
+        SystemOutputModule *_output = nullptr;
+
+        bool _is_running = false;
+
+        // Only denormal flushing, the device thread belonging to the backend.
+        ThreadConfig _thread_config;
+
+    public:
+        CallbackDriver(AudioProcessor *processor, SystemAudio *system, SystemOutputModule *output);
+        ~CallbackDriver();
+
+        /**
+         * @brief set_thread_config Set how the processor is run on the device's thread. As the thread belongs to the
+         *                          backend, only denormal flushing is applied, at the start of every render.
+         *                          Must be called while not running.
+         */
+        void set_thread_config(const ThreadConfig &config);
+
+        /**
+         * @brief start Start rendering from the device callback. The processor's thread count must be 1.
+         */
+        void start();
+        void finish();
+
+        void render(float *frames, uint32_t frame_count) override;
+    };
+}
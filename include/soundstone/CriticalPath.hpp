@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <soundstone/testable_export.h>
+
+namespace soundstone {
+
+    /**
+     * Ranks the nodes of a topologically ordered graph by the cost of the longest path from each node to the end of
+     * the graph, so that work on the critical path can be started ahead of work which can wait.
+     *
+     * With no costs measured, every node costs 1, and the critical path is simply the one with the most nodes. This
+     * is how AudioProcessor ranks modules unless built with SOUNDSTONE_MODULE_STATS, as it only times them then.
+     */
+    class SOUNDSTONE_TESTABLE_EXPORT CriticalPath {
+    public:
+        /**
+         * @brief measure Find the length of the critical path from every node.
+         * @param dependencies For each node, the nodes it depends on. Nodes must be in topological order, so every
+         *                     dependency has a lower index than the node depending on it.
+         * @param costs        What each node costs to run. Nodes costing 0 haven't been measured, and are taken to
+         *                     cost as much as the average node which has, or 1 when none has.
+         * @param lengths      Set to the cost of the longest path from each node to the end of the graph, the node's
+         *                     own cost included.
+         */
+        static void measure(
+            const std::vector<std::vector<uint32_t>> &dependencies,
+            const std::vector<uint64_t> &costs,
+            std::vector<uint64_t> &lengths
+        );
+    };
+}
@@ -27,10 +27,26 @@ namespace soundstone {
         void add_dependency(T dependee, T dependency);
         void remove_dependency(T dependee, T dependency);
         void clear();
+
+        /**
+         * @brief depends_on Check if a node depends on another, directly or through other nodes.
+         */
+        bool depends_on(T dependee, T dependency) const;
+
+        /**
+         * @brief resolve Order the nodes so that every node comes after its dependencies.
+         *
+         * Nodes are ordered depth first, so a node tends to come right after the last of its dependencies.
+         *
+         * @param count Set to the number of nodes resolved.
+         * @return The resolved nodes, or nullptr with a count of zero if the graph has a cycle.
+         */
         std::unique_ptr<T[]> resolve(uint32_t &count) const;
 
     };
 
     extern template class GraphNode<uint32_t>;
     extern template class DependencyGraph<uint32_t>;
+    extern template class GraphNode<Module *>;
+    extern template class DependencyGraph<Module *>;
 }
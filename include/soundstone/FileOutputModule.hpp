@@ -0,0 +1,21 @@
+#pragma once
+#include "Module.hpp"
+#include "AudioFileWriter.hpp"
+
+namespace soundstone {
+    /**
+     * Writes its first input to a file. The input has as many channels as the writer, so the writer must be opened
+     * before the module is constructed. Nothing is written while the writer is closed.
+     */
+    class SOUNDSTONE_EXPORT FileOutputModule : public Module {
+        AudioFileWriter *_writer = nullptr;
+        uint32_t _channel_count = 1;
+
+    public:
+        FileOutputModule(AudioFileWriter *writer);
+
+        uint32_t channel_count() const override;
+        void commit() override;
+        void sample(const float *const *input_buffers, float *output_buffer, uint32_t nsamples) override;
+    };
+}
@@ -7,6 +7,12 @@ namespace soundstone {
 
     class SOUNDSTONE_EXPORT Module {
     public:
+        // Every buffer passed to sample starts on a boundary of this many bytes.
+        static const size_t BUFFER_ALIGNMENT = 64;
+        // Every buffer passed to sample has room for its samples rounded up to a multiple of this many, so vector
+        // loops can run over the whole buffer without handling a remainder. Samples past the end are left as garbage.
+        static const uint32_t BUFFER_PADDING = 16;
+
         virtual ~Module() = default;
 
         /**
@@ -17,17 +23,75 @@ namespace soundstone {
          */
         virtual void commit() = 0;
 
+        /**
+         * @brief input_count The number of inputs the module reads. Inputs which aren't routed read silence.
+         *
+         * Called when the module is added, from a thread other than the one sampling, and must not change while the
+         * module is added. Defaults to one.
+         */
+        virtual uint32_t input_count() const;
+
+        /**
+         * @brief channel_count The number of channels the module outputs.
+         *
+         * Called when the graph is built, from a thread other than the one sampling, and must not change while the
+         * module is added. Defaults to one.
+         */
+        virtual uint32_t channel_count() const;
+
+        /**
+         * @brief input_channel_count The number of channels the module expects at an input. Inputs routed from
+         *                            modules with a different number of channels are converted: mono is copied to
+         *                            every channel, anything mixed down to mono is averaged, and otherwise extra
+         *                            channels are dropped and missing ones are silent.
+         *
+         * Called when the graph is built, like channel_count. Defaults to channel_count.
+         */
+        virtual uint32_t input_channel_count(uint32_t index) const;
+
         /**
          * @brief sample Generate samples
-         * @param input_buffers Sample data from modules routed to this module.
-         * @param output_buffer Buffer to sample into.
-         * @param nsamples      Length of the given buffers.
+         *
+         * Buffers are planar, each channel being nsamples samples following on from the last channel. Buffers are
+         * aligned to BUFFER_ALIGNMENT and padded to BUFFER_PADDING samples. Every channel is aligned too when nsamples
+         * is a multiple of BUFFER_PADDING, which holds for every call except the last block of an update that isn't
+         * a whole number of blocks.
+         *
+         * @param input_buffers Sample data for each of the input_count inputs, with input_channel_count channels.
+         * @param output_buffer Buffer to sample into, with channel_count channels.
+         * @param nsamples      Number of samples in each channel of the given buffers.
          */
         virtual void sample(
             const float * const *input_buffers,
             float *output_buffer,
             uint32_t nsamples
         ) = 0;
+
+        /**
+         * @brief preserves_silence Whether the output is always silent when every input is. The processor skips
+         *                          sampling such modules while their inputs are silent, and fills their output with
+         *                          silence instead. Unrouted inputs are silent, so modules producing sound of their own
+         *                          must not claim this.
+         *
+         * Called when the graph is built, like channel_count. Defaults to false.
+         */
+        virtual bool preserves_silence() const;
+
+        /**
+         * @brief sample_with_silence Generate samples, knowing which inputs are silent.
+         *
+         * Override this instead of sample to skip work on silent inputs, or to report a silent output so modules
+         * downstream can skip work too. Defaults to calling sample and reporting sound.
+         *
+         * @param silent_inputs For each input, whether every sample of it is zero.
+         * @return True if every sample written to the output buffer is zero.
+         */
+        virtual bool sample_with_silence(
+            const float * const *input_buffers,
+            const bool *silent_inputs,
+            float *output_buffer,
+            uint32_t nsamples
+        );
     };
 
 }
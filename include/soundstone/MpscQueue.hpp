@@ -0,0 +1,113 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+
+namespace soundstone {
+
+    /**
+     * A bounded queue which any number of threads may push to and one thread pops from. Slots are allocated up front,
+     * and neither pushing nor popping ever blocks or allocates. Pushing to a full queue fails instead of waiting.
+     *
+     * Each slot carries a sequence number telling whether it is ready to be written or read for the current lap
+     * around the queue (Vyukov's bounded queue). The capacity is always a power of two.
+     */
+    template <typename T>
+    class MpscQueue {
+        class Slot {
+        public:
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Slot[]> _slots;
+        size_t _mask = 0;
+
+        alignas(64) std::atomic<size_t> _push_position {0};
+        alignas(64) size_t _pop_position = 0;
+
+    public:
+        explicit MpscQueue(size_t capacity) {
+            size_t rounded_capacity = 1;
+            while (rounded_capacity < capacity) {
+                rounded_capacity <<= 1;
+            }
+
+            _slots = std::unique_ptr<Slot[]>(new Slot[rounded_capacity]);
+            _mask = rounded_capacity - 1;
+            for (size_t i = 0; i < rounded_capacity; ++i) {
+                _slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscQueue(const MpscQueue &) = delete;
+        MpscQueue &operator=(const MpscQueue &) = delete;
+
+        size_t capacity() const {
+            return _mask + 1;
+        }
+
+        /**
+         * @brief push_count The number of values ever pushed or in the middle of being pushed.
+         */
+        size_t push_count() const {
+            return _push_position.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief pop_count The number of values ever popped. Only the consuming thread may call this.
+         */
+        size_t pop_count() const {
+            return _pop_position;
+        }
+
+        /**
+         * @brief push Add a value to the back of the queue. May be called from any thread.
+         * @return False if the queue is full, in which case the value is not added.
+         */
+        bool push(const T &value) {
+            size_t position = _push_position.load(std::memory_order_relaxed);
+            Slot *slot;
+            for (;;) {
+                slot = &_slots[position & _mask];
+                size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (difference == 0) {
+                    // The slot is free for this lap, try to claim it.
+                    if (_push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    // The slot still holds a value from the previous lap which hasn't been popped.
+                    return false;
+                } else {
+                    // Another thread claimed the slot first.
+                    position = _push_position.load(std::memory_order_relaxed);
+                }
+            }
+
+            slot->value = value;
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief pop Take the value at the front of the queue. Only the consuming thread may pop.
+         * @return False if the queue is empty, or the next value is still being pushed.
+         */
+        bool pop(T &value) {
+            Slot &slot = _slots[_pop_position & _mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence != _pop_position + 1) {
+                return false;
+            }
+
+            value = slot.value;
+            // Hand the slot back to producers for the next lap.
+            slot.sequence.store(_pop_position + _mask + 1, std::memory_order_release);
+            ++_pop_position;
+            return true;
+        }
+    };
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "SystemAudioBackend.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace soundstone {
+    /**
+     * A backend without a device. It pulls one period of frames at a time on a simulated clock, either paced against
+     * the wall clock on a thread of its own, or only when advance is called, so device timing and underflows can be
+     * reproduced exactly. What it pulls can be kept for reading back.
+     */
+    class SOUNDSTONE_EXPORT NullAudioBackend final : public SystemAudioBackend {
+    public:
+        enum class Clock {
+            // Periods are pulled on a thread of the backend's own, at the sample rate.
+            REALTIME,
+            // Periods are only pulled by advance, on the calling thread.
+            MANUAL
+        };
+
+    private:
+        uint32_t _sample_rate;
+        uint32_t _period_frames;
+        Clock _clock;
+
+        uint32_t _channel_count = 0;
+        Callbacks *_callbacks = nullptr;
+        std::unique_ptr<float[]> _period;
+
+        // Guards everything below. Never held while calling back, so callbacks may call start.
+        mutable std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _is_open = false;
+        bool _is_started = false;
+        uint64_t _frames_played = 0;
+        uint64_t _underflow_count = 0;
+        bool _is_loopback_enabled = false;
+        std::vector<float> _loopback;
+
+        std::thread _thread;
+
+        void worker();
+        void pull_period();
+
+    public:
+        NullAudioBackend(uint32_t sample_rate = 48000, uint32_t period_frames = 256, Clock clock = Clock::REALTIME);
+        ~NullAudioBackend() override;
+
+        bool open(uint32_t channel_count, Callbacks *callbacks) override;
+        void close() override;
+        bool start() override;
+        uint32_t sample_rate() const override;
+        uint32_t latency() const override;
+
+        /**
+         * @brief advance Pull period_count periods on the calling thread, as a MANUAL clock. Periods while the stream
+         *                is drained are skipped, as a device would.
+         */
+        void advance(uint32_t period_count);
+
+        /**
+         * @brief frames_played The number of frames pulled from the callbacks, not counting the silence filling
+         *                      underflowing periods.
+         */
+        uint64_t frames_played() const;
+
+        /**
+         * @brief underflow_count The number of periods which couldn't be filled.
+         */
+        uint64_t underflow_count() const;
+
+        /**
+         * @brief set_loopback_enabled Keep every period pulled from now on, for take_loopback.
+         */
+        void set_loopback_enabled(bool is_enabled);
+
+        /**
+         * @brief take_loopback The interleaved frames kept since the last call, underflows being filled with silence.
+         */
+        std::vector<float> take_loopback();
+    };
+}
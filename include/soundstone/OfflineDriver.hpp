@@ -0,0 +1,46 @@
+#pragma once
+#include "AudioProcessor.hpp"
+
+#include <chrono>
+
+namespace soundstone {
+    /**
+     * Runs the processor as fast as it will go, for a set number of frames, without any audio device. Pair it with
+     * a FileOutputModule to render to a file.
+     */
+    class SOUNDSTONE_EXPORT OfflineDriver final {
+    public:
+        class Report {
+        public:
+            uint64_t frame_count = 0;
+            uint32_t sample_rate = 0;
+            std::chrono::nanoseconds elapsed {0};
+
+            /**
+             * @brief realtime_factor How many seconds of audio were rendered per second taken, so above one is
+             *                        faster than realtime.
+             */
+            double realtime_factor() const;
+        };
+
+        // The most frames the processor is updated for at once.
+        static const uint32_t UPDATE_FRAMES = 65536;
+
+    private:
+        AudioProcessor *_processor = nullptr;
+        uint32_t _sample_rate = 0;
+
+    public:
+        OfflineDriver(AudioProcessor *processor, uint32_t sample_rate);
+
+        /**
+         * @brief render Apply any changes queued so far, then update the processor for frame_count frames.
+         */
+        Report render(uint64_t frame_count);
+
+        /**
+         * @brief render_for Render however many frames last duration at the sample rate.
+         */
+        Report render_for(std::chrono::nanoseconds duration);
+    };
+}
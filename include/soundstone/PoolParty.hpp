@@ -1,28 +1,143 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <queue>
 #include <mutex>
 #include <memory>
 #include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include "WorkStealingDeque.hpp"
+#include "ThreadConfig.hpp"
 
 namespace soundstone {
 
     class PoolParty final {
-        class WorkInfo {
+    public:
+        enum class Scheduler {
+            // All workers take ready work from one shared list, highest priority first and otherwise in the order it
+            // became ready.
+            SHARED,
+            // Each worker keeps the work it made ready in its own deque and steals from other workers when it runs
+            // out, so chains of dependent work tend to stay on the same thread. Priority only orders the work ready
+            // from the start and the work each worker makes ready at once.
+            WORK_STEALING
+        };
+
+        // The shared scheduler groups priorities into at most this many bands. Work in the same band is taken in the
+        // order it became ready.
+        static const uint32_t MAX_PRIORITY_BANDS = 16;
+
+        /**
+         * How threads wait when there is nothing for them to do, either between calls to work or while waiting on
+         * dependencies. A waiting thread first busy waits, then yields to other threads, and then sleeps until woken.
+         * Longer spin and yield times make threads pick up work sooner, at the cost of burning CPU time while idle.
+         */
+        class WaitPolicy {
         public:
-            std::function<void()> func;
-            uint32_t id;
-            const uint32_t *dependencies;
-            uint32_t dependency_count;
+            std::chrono::nanoseconds spin_time;
+            std::chrono::nanoseconds yield_time;
+
+            WaitPolicy(
+                std::chrono::nanoseconds spin_time = std::chrono::microseconds(10),
+                std::chrono::nanoseconds yield_time = std::chrono::nanoseconds(0)
+            );
         };
 
+        /**
+         * A set of work with dependencies, along with everything needed to run it. Preparing a work set allocates,
+         * while running a prepared one doesn't, so a set can be prepared on one thread and then handed over to
+         * the thread calling work.
+         */
+        class WorkSet {
+            friend class PoolParty;
+
+            class WorkInfo {
+            public:
+                std::function<void()> func;
+                const uint32_t *dependencies;
+                uint32_t dependency_count;
+                uint64_t priority;
+            };
+
+            std::vector<WorkInfo> _work;
+            bool _is_dirty = true;
+
+            // Dependents of each piece of work, stored as one list indexed by offset.
+            std::vector<uint32_t> _dependent_offsets;
+            std::vector<uint32_t> _dependents;
+            std::vector<uint32_t> _dependency_counts;
+            std::vector<uint32_t> _initial_work;
+
+            // The band of each piece of work, and where each band's slots start in the ready list.
+            std::vector<uint32_t> _work_bands;
+            std::vector<uint32_t> _band_offsets;
+            uint32_t _band_count = 0;
+
+            // Per-call scheduling state. Each piece of work counts down its unfinished dependencies and is put in the
+            // ready list by whichever thread finishes its last dependency. Every piece of work becomes ready exactly
+            // once per call, so each band of the ready list has a slot for every piece of work in it.
+            std::unique_ptr<std::atomic<uint32_t>[]> _unfinished_dependency_counts;
+            std::unique_ptr<std::atomic<uint32_t>[]> _ready;
+            std::unique_ptr<std::atomic<uint32_t>[]> _band_push_counts;
+            std::unique_ptr<std::atomic<uint32_t>[]> _band_pop_counts;
+            uint32_t _work_count = 0;
+
+            // Work stealing deques, one per worker plus one for the thread calling work.
+            std::unique_ptr<WorkStealingDeque[]> _deques;
+            uint32_t _prepared_worker_count = 0;
+            Scheduler _prepared_scheduler = Scheduler::SHARED;
+
+            bool is_prepared_for(uint32_t worker_count) const;
+
+        public:
+            void add_work(std::function<void()> function);
+            void add_work(std::function<void()> function, const uint32_t *dependencies, uint32_t dependency_count);
+
+            /**
+             * @brief add_work Add work which is picked up ahead of lower priority work, as far as the scheduler allows.
+             *                 Work added without a priority has priority 0.
+             */
+            void add_work(
+                std::function<void()> function, const uint32_t *dependencies, uint32_t dependency_count,
+                uint64_t priority
+            );
+            void clear();
+
+            /**
+             * @brief prepare Build everything needed to run the work on a party with the given settings. The set
+             *                then runs with the given scheduler, whichever the party is set to. Work sets which
+             *                aren't prepared are prepared by work with the party's scheduler, and work stealing sets
+             *                prepared for another number of workers are prepared again.
+             */
+            void prepare(uint32_t worker_count, Scheduler scheduler);
+        };
+
+    private:
+        static const uint32_t NO_WORK = UINT32_MAX;
+
         std::unique_ptr<std::thread[]> _threads;
 
-        std::vector<WorkInfo> _work;
-        std::unique_ptr<bool[]> _completion_status;
-        std::mutex _work_mutex;
-        std::condition_variable _update_condition;
+        // The work set used by add_work, clear_work and work without arguments.
+        WorkSet _own_work;
+        // The work set of the current or last call. Workers read this when they join a call.
+        WorkSet *_current_work = nullptr;
+
+        // Low bits are the number of claims on ready work so far, high bits are the generation of the call they
+        // belong to. Each claim entitles a thread to one piece of ready work, whichever has the highest priority once
+        // it's there. Workers late to notice a call has finished see a different generation and can't claim work
+        // from the next call.
+        std::atomic<uint64_t> _ready_claim_position {0};
+        std::atomic<uint32_t> _remaining_work {0};
+
+        // Work stealing state. Work with no dependencies is handed out from a shared list, everything else goes to the
+        // deque of the worker which finished its last dependency.
+        Scheduler _scheduler = Scheduler::SHARED;
+        std::atomic<uint32_t> _initial_work_index {0};
+        std::atomic<uint32_t> _active_workers {0};
 
         std::condition_variable _start_condition;
         std::mutex _start_mutex;
@@ -30,23 +145,97 @@ namespace soundstone {
         std::condition_variable _finished_condition;
         std::mutex _finished_mutex;
 
+        // Sleeping threads waiting for work to become ready. The epoch is bumped whenever work is made ready, and
+        // sleepers wait for it to change.
+        std::condition_variable _idle_condition;
+        std::mutex _idle_mutex;
+        std::atomic<uint32_t> _idle_epoch {0};
+        std::atomic<uint32_t> _idle_thread_count {0};
+
         uint32_t _worker_count = 0;
+        WaitPolicy _wait_policy;
+
+        // Applied by each worker as it starts, which reports back before setup returns.
+        ThreadConfig _thread_config;
+        std::vector<ThreadConfig::Report> _thread_config_reports;
+        std::atomic<uint32_t> _configured_worker_count {0};
 
-        bool _is_working = false;
-        //std::mutex _is_working_mutex;
+        std::atomic<uint64_t> _generation {0};
 
-        bool _should_quit = false;
-        //std::mutex _should_quit_mutex;
+        std::atomic<bool> _should_quit {false};
 
-        void worker_routine();
+        void worker_routine(uint64_t generation, uint32_t worker_index);
         void shutdown();
+        void reset_work_state(WorkSet &set);
+
+        void run_shared(WorkSet &set, uint64_t generation);
+        void push_ready(WorkSet &set, uint32_t id);
+        uint32_t pop_ready(WorkSet &set);
+        uint32_t wait_for_ready(WorkSet &set);
+        bool claim_ready_work(uint64_t generation, uint32_t work_count);
+
+        void run_work_stealing(WorkSet &set, uint32_t worker_index);
+        uint32_t take_initial_work(WorkSet &set);
+        uint32_t steal_work(WorkSet &set, uint32_t worker_index);
+
+        void finish_work(WorkSet &set, uint32_t id, WorkStealingDeque *deque);
+
+        template <typename Predicate>
+        bool spin_then_yield(Predicate predicate) const;
+        template <typename Predicate>
+        void wait_until(Predicate predicate);
+        void wake_idle();
 
     public:
         ~PoolParty();
+
+        /**
+         * @brief setup Start worker threads.
+         * @param worker_count The number of threads to start. The thread calling work always runs work as well, so
+         *                     no threads are needed to get work done.
+         * @param wait_policy  How the worker threads and the thread calling work wait for work.
+         * @param thread_config How the worker threads are set up. Not applied to the thread calling work.
+         */
         void setup(uint32_t worker_count);
+        void setup(uint32_t worker_count, const WaitPolicy &wait_policy);
+        void setup(uint32_t worker_count, const WaitPolicy &wait_policy, const ThreadConfig &thread_config);
+
+        /**
+         * @brief thread_config_reports What took effect on each worker thread when the thread config was applied.
+         */
+        const std::vector<ThreadConfig::Report> &thread_config_reports() const;
+
+        /**
+         * @brief set_scheduler Choose how workers pick up ready work from the party's own work, and from work sets
+         *                      which haven't been prepared. Work sets prepared beforehand run with the scheduler
+         *                      they were prepared for. Must not be called while work is in progress.
+         */
+        void set_scheduler(Scheduler scheduler);
         void add_work(std::function<void()> function);
         void add_work(std::function<void()> function, const uint32_t *dependency, uint32_t dependency_count);
+        void add_work(
+            std::function<void()> function, const uint32_t *dependency, uint32_t dependency_count, uint64_t priority
+        );
+        void clear_work();
+
+        /**
+         * @brief work Run every piece of added work once, respecting dependencies.
+         *
+         * Added work is kept between calls, so a static set of work only needs to be added once and can then be
+         * run any number of times. Use clear_work to change the set of work.
+         */
         void work();
+
+        /**
+         * @brief work Run every piece of work in a work set once, respecting dependencies.
+         *
+         * Nothing is allocated if the set was prepared for this party's current settings. Once work has been called
+         * with a different set, no worker will look at the previous set again.
+         */
+        void work(WorkSet &set);
+
+        uint32_t worker_count() const;
+        Scheduler scheduler() const;
     };
 
 }
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <atomic>
+#include <soundstone/testable_export.h>
+
+namespace soundstone {
+
+    /**
+     * A fixed capacity ring buffer for exactly one producing thread and one consuming thread. Neither side ever
+     * blocks or allocates, so it is safe to use from a realtime audio callback. The capacity is always a power of two.
+     */
+    template <typename T>
+    class SOUNDSTONE_TESTABLE_EXPORT SpscRingBuffer {
+        T *_buffer = nullptr;
+        size_t _capacity = 0;
+        size_t _mask = 0;
+
+        // Total number of items ever consumed and produced. Kept on separate cache lines so the two threads don't
+        // fight over them.
+        alignas(64) std::atomic<size_t> _read_index {0};
+        alignas(64) std::atomic<size_t> _write_index {0};
+
+    public:
+        SpscRingBuffer();
+        explicit SpscRingBuffer(size_t capacity);
+        SpscRingBuffer(const SpscRingBuffer &) = delete;
+        SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+        ~SpscRingBuffer();
+
+        /**
+         * @brief reserve Replace the buffer with an empty one of at least the given capacity, rounded up to a power
+         *                of two. Must not be called while either thread is using the buffer.
+         */
+        void reserve(size_t capacity);
+
+        size_t capacity() const;
+
+        /**
+         * @brief size The number of items available to consume. Exact when called from either the producing or
+         *             consuming thread, otherwise a snapshot.
+         */
+        size_t size() const;
+
+        /**
+         * @brief produce Copy as many items into the buffer as there is space for. Only the producing thread may
+         *                produce.
+         * @return The number of items copied.
+         */
+        size_t produce(const T *data, size_t count);
+
+        /**
+         * @brief consume Copy up to count items out of the buffer. Only the consuming thread may consume.
+         * @return The number of items copied.
+         */
+        size_t consume(T *data, size_t count);
+    };
+
+    extern template class SpscRingBuffer<float>;
+}
@@ -1,43 +1,158 @@
 #pragma once
 #include <soundstone/export.h>
-#include "RingBuffer.hpp"
+#include "SpscRingBuffer.hpp"
+#include "SystemAudioBackend.hpp"
+#include "TimingWindow.hpp"
 
 #include <mutex>
 #include <functional>
+#include <memory>
+#include <atomic>
+#include <array>
 
 namespace soundstone {
 
+    /**
+     * Plays interleaved frames queued with update through a backend, the system's default output device unless
+     * another is given.
+     */
     class SOUNDSTONE_EXPORT SystemAudio {
+    public:
+        /**
+         * Renders frames on the device's own thread, straight into the device's buffer, instead of them being
+         * queued with update.
+         */
+        class Renderer {
+        public:
+            virtual ~Renderer() = default;
+
+            /**
+             * @brief render Fill the buffer with interleaved frames. Called from the device callback, so must never
+             *               block or allocate.
+             */
+            virtual void render(float *frames, uint32_t frame_count) = 0;
+        };
+
+        /**
+         * Told when the frames queued for playback fall to the low-water mark, so whatever queues them can sleep
+         * until then rather than polling.
+         */
+        class LowWaterListener {
+        public:
+            virtual ~LowWaterListener() = default;
+
+            /**
+             * @brief on_low_water Called from the device callback, so must never block or allocate.
+             */
+            virtual void on_low_water() = 0;
+        };
+
+        /**
+         * How the device callback has been keeping up, gathered since the system audio was created.
+         */
+        class Telemetry {
+        public:
+            // Bucket 0 counts callbacks finding nothing queued, and bucket i those finding at least 2^(i-1) frames
+            // and fewer than 2^i, the last bucket taking everything larger.
+            static const uint32_t DEPTH_BUCKET_COUNT = 18;
+
+            uint64_t callback_count = 0;
+            // Callbacks which couldn't be given every frame asked for, and how many frames they went without.
+            uint64_t underflow_count = 0;
+            uint64_t short_fill_frames = 0;
+
+            // Frames queued when callbacks started, not counting callbacks made while rendering.
+            uint32_t min_buffered_frames = 0;
+            uint32_t max_buffered_frames = 0;
+            std::array<uint64_t, DEPTH_BUCKET_COUNT> buffered_frames_histogram {};
+
+            // Time spent in each callback.
+            TimingWindow::Summary callback_duration;
+            // How far each callback started from when the previous one's frames ran out. Not measured across
+            // underflows, after which the device restarts.
+            TimingWindow::Summary period_jitter;
+        };
+
+    private:
         class Internal;
 
+        // In frames, each holding one sample per channel.
+        static const size_t BUFFER_CAPACITY = 1 << 16;
+
         std::unique_ptr<Internal> _internal;
-        mutable std::mutex _data_mutex;
+        uint32_t _channel_count = 1;
         uint32_t _sample_rate = 0;
         uint32_t _latency = 0;
-        RingBuffer<float> _data;
+
+        // Interleaved frames, written by update and read by the device callback, which must never block or allocate.
+        SpscRingBuffer<float> _data;
 
         std::function<void()> _drained_callback;
         std::mutex _drained_callback_mutex;
 
         std::mutex _stream_state_mutex;
 
-        bool init_cubeb();
-        void destroy_cubeb();
+        // The callback counts itself in before looking at the renderer or listener, so setting either can wait for
+        // any callback still using the previous one.
+        std::atomic<Renderer *> _renderer {nullptr};
+        std::atomic<LowWaterListener *> _low_water_listener {nullptr};
+        std::atomic<uint32_t> _low_water_frames {0};
+        std::atomic<uint32_t> _active_callback_count {0};
+
+        void wait_for_callbacks();
+        void restart_drained_stream();
 
     public:
-        SystemAudio();
+        explicit SystemAudio(uint32_t channel_count = 1);
+
+        /**
+         * @brief SystemAudio Play through the given backend instead of the system's default output device.
+         */
+        SystemAudio(std::unique_ptr<SystemAudioBackend> backend, uint32_t channel_count = 1);
         ~SystemAudio();
 
         bool is_ok() const;
         bool is_steam_ok() const;
         bool is_stream_playing() const;
         bool is_stream_drained() const;
+        /**
+         * @brief samples_buffered The number of frames queued for playback, each holding one sample per channel.
+         */
         uint32_t samples_buffered() const;
+        uint32_t channel_count() const;
         uint32_t sample_rate() const;
         uint32_t latency() const;
 
-        void update(const float *data, size_t sample_count);
+        /**
+         * @brief update Queue interleaved frames for playback. Must only be called from one thread at a time.
+         * @return The number of frames queued. Frames which don't fit in the buffer are dropped.
+         */
+        size_t update(const float *data, size_t frame_count);
+
+        /**
+         * @brief set_drained_callback Called on the device thread whenever the stream runs out of queued frames.
+         *                             Use telemetry to count underflows from other threads.
+         */
         void set_drained_callback(std::function<void()> callback);
 
+        /**
+         * @brief telemetry Read what the device callback has published. Never blocks the callback, though fields
+         *                  may be from callbacks a moment apart.
+         */
+        Telemetry telemetry() const;
+
+        /**
+         * @brief set_renderer Render frames from inside the device callback, or go back to playing queued frames
+         *                     if the renderer is null. Once this returns, the previous renderer is no longer used.
+         */
+        void set_renderer(Renderer *renderer);
+
+        /**
+         * @brief set_low_water_listener Tell a listener whenever a device callback takes the number of queued frames
+         *                               from above low_water_frames to at or below it. Once this returns, the previous
+         *                               listener is no longer used.
+         */
+        void set_low_water_listener(LowWaterListener *listener, uint32_t low_water_frames);
+
     };
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+#include <soundstone/export.h>
+#include <cstdint>
+
+namespace soundstone {
+    /**
+     * The device a SystemAudio plays through. A backend pulls interleaved float frames from its callbacks on its own
+     * schedule, and reports when the stream starts, drains or fails.
+     */
+    class SOUNDSTONE_EXPORT SystemAudioBackend {
+    public:
+        enum class State {
+            STARTED,
+            STOPPED,
+            DRAINED,
+            ERROR
+        };
+
+        class Callbacks {
+        public:
+            virtual ~Callbacks() = default;
+
+            /**
+             * @brief data Fill frames with up to frame_count interleaved frames. Called from the device thread, so
+             *             must never block or allocate.
+             * @return The number of frames written. Fewer than frame_count drains the stream until it is started
+             *         again.
+             */
+            virtual long data(float *frames, long frame_count) = 0;
+
+            /**
+             * @brief state_changed Called whenever the stream changes state, possibly from the device thread.
+             */
+            virtual void state_changed(State state) = 0;
+        };
+
+        virtual ~SystemAudioBackend() = default;
+
+        /**
+         * @brief open Open a stream with channel_count channels, which calls back into callbacks once started.
+         * @return false if there is no device to open.
+         */
+        virtual bool open(uint32_t channel_count, Callbacks *callbacks) = 0;
+
+        /**
+         * @brief close Stop the stream. No callbacks are made once this returns.
+         */
+        virtual void close() = 0;
+
+        /**
+         * @brief start Start the stream, or restart it once drained. May be called from inside state_changed.
+         */
+        virtual bool start() = 0;
+
+        /**
+         * @brief sample_rate The stream's sample rate, once opened.
+         */
+        virtual uint32_t sample_rate() const = 0;
+
+        /**
+         * @brief latency The stream's latency in frames, once opened.
+         */
+        virtual uint32_t latency() const = 0;
+    };
+}
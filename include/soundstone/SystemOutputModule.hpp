@@ -2,15 +2,45 @@
 #include "Module.hpp"
 #include "SystemAudio.hpp"
 
+#include <memory>
+
 namespace soundstone {
+    /**
+     * Plays its first input through system audio. The input has as many channels as the system audio, and is
+     * interleaved on its way out.
+     */
     class SystemOutputModule : public Module {
+        // Frames interleaved at a time.
+        static const uint32_t INTERLEAVE_FRAMES = 256;
+
         SystemAudio *_audio = nullptr;
+        uint32_t _channel_count = 1;
+        std::unique_ptr<float[]> _interleaved;
+
+        // Where frames are rendered to instead of being queued, while a driver renders from the device callback.
+        float *_render_frames = nullptr;
+        uint32_t _render_frame_count = 0;
+        uint32_t _rendered_frame_count = 0;
 
     public:
         SystemOutputModule(SystemAudio *audio);
 
+        uint32_t channel_count() const override;
         void commit() override;
         void sample(const float *const *input_buffers, float *output_buffer, uint32_t nsamples) override;
+
+        /**
+         * @brief start_rendering Interleave frames straight into a buffer instead of queuing them with the system
+         *                        audio, until finish_rendering is called. Used by drivers running the processor
+         *                        from inside the device callback. Frames past frame_count are dropped.
+         */
+        void start_rendering(float *frames, uint32_t frame_count);
+
+        /**
+         * @brief finish_rendering Go back to queuing frames with the system audio.
+         * @return The number of frames rendered since start_rendering.
+         */
+        uint32_t finish_rendering();
     };
 }
 
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <soundstone/export.h>
+
+namespace soundstone {
+    /**
+     * How a thread running audio should be set up. Applied by every thread soundstone starts to run audio work, and
+     * can be applied by hand to the thread calling AudioProcessor::update. Nothing is changed unless asked for, and
+     * settings the platform or the process's privileges don't allow are skipped rather than failing.
+     */
+    class SOUNDSTONE_EXPORT ThreadConfig {
+    public:
+        enum class Policy {
+            // Leave the thread's scheduling alone.
+            DEFAULT,
+            FIFO,
+            ROUND_ROBIN
+        };
+
+        /**
+         * Which of the settings asked for took effect. Settings which weren't asked for are false.
+         */
+        class Report {
+        public:
+            bool priority = false;
+            bool affinity = false;
+            bool memory_locked = false;
+            bool stack_prefaulted = false;
+            bool denormals_flushed = false;
+        };
+
+        Policy policy = Policy::DEFAULT;
+        // Clamped to the range the policy allows.
+        int priority = 0;
+
+        // CPUs the thread may run on, or any if empty. Only supported on Linux.
+        std::vector<uint32_t> cpus;
+
+        // Lock every page of the process into memory, now and in future, so the audio never waits on a page fault.
+        // Affects the whole process.
+        bool lock_memory = false;
+        // Touch this many bytes of the thread's stack up front, so none of it faults in later. Must be well under
+        // the thread's stack size.
+        size_t prefault_stack_bytes = 0;
+
+        // Flush denormal results and inputs to zero, which keeps decaying signals from slowing down to a crawl.
+        bool flush_denormals = false;
+
+        /**
+         * @brief apply Apply the settings to the calling thread.
+         */
+        Report apply() const;
+
+        /**
+         * @brief apply_flush_denormals Only flush denormals on the calling thread, which is cheap enough to do on
+         *                              a thread soundstone doesn't own, every time it is handed one.
+         */
+        bool apply_flush_denormals() const;
+    };
+}
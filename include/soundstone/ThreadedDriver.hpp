@@ -1,17 +1,24 @@
 #pragma once
 #include "AudioProcessor.hpp"
 #include "SystemAudio.hpp"
+#include "ThreadConfig.hpp"
 
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
 
 namespace soundstone {
-    class ThreadedDriver final {
+    /**
+     * Keeps the system audio queue between a low and a high water mark from its own thread. The device callback wakes
+     * the driver when the queue falls to the low-water mark, and a timer set for when it should get there covers any
+     * wake-up which is missed.
+     */
+    class ThreadedDriver final : private SystemAudio::LowWaterListener {
 
         AudioProcessor *_processor = nullptr;
-        const SystemAudio *_system = nullptr;
+        SystemAudio *_system = nullptr;
 
         std::thread _thread;
 
@@ -19,21 +26,58 @@ namespace soundstone {
         std::mutex _is_running_mutex;
         std::condition_variable _is_running_condition;
 
+        // Set by the device callback without taking the mutex, so a wake-up can be missed while the worker is between
+        // checking it and waiting. The worker never waits past the predicted low-water time, which bounds the cost.
+        std::atomic<bool> _is_woken {false};
+
         std::chrono::nanoseconds _update_interval = std::chrono::milliseconds(15);
-        uint32_t _latency_samples = 512;
+        uint32_t _low_water_samples = 256;
+        uint32_t _high_water_samples = 512;
+
+        // Applied by the worker as it starts, which reports back before start returns. Guarded by the running mutex.
+        ThreadConfig _thread_config;
+        ThreadConfig::Report _thread_config_report;
+        bool _is_configured = false;
 
         void worker();
-        bool worker_should_run();
+        std::chrono::nanoseconds time_until_low_water(uint32_t buffered_samples, uint32_t sample_rate) const;
+
+        void on_low_water() override;
 
     public:
-        ThreadedDriver(soundstone::AudioProcessor *processor, const SystemAudio *system);
+        ThreadedDriver(soundstone::AudioProcessor *processor, SystemAudio *system);
         ~ThreadedDriver();
 
+        /**
+         * @brief set_update_interval The longest the driver sleeps when the device gives it no better idea, such as
+         *                            when the queue cannot be filled past the low-water mark. Takes effect on start.
+         */
         void set_update_interval(std::chrono::nanoseconds ns);
+
+        /**
+         * @brief set_latency_samples Set the high-water mark, which is how many samples the driver queues each time
+         *                            it wakes. Takes effect on start.
+         */
         void set_latency_samples(uint32_t latency_samples);
+
+        /**
+         * @brief set_low_water_samples Set how few samples may be left queued before the driver wakes to render more.
+         *                              It needs to cover the time taken to wake and render. Takes effect on start.
+         */
+        void set_low_water_samples(uint32_t low_water_samples);
+
+        /**
+         * @brief set_thread_config Set up the driver's thread, which runs the processor. Takes effect on start.
+         */
+        void set_thread_config(const ThreadConfig &config);
+
+        /**
+         * @brief thread_config_report What took effect on the driver's thread when it was last started.
+         */
+        ThreadConfig::Report thread_config_report();
+
         void start();
         void finish();
 
     };
 }
-
@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <soundstone/testable_export.h>
+
+namespace soundstone {
+
+    /**
+     * The durations of the last CAPACITY runs of something, recorded by one thread at a time without blocking and
+     * summarized from any other. Readers retry while a record is being written, so they never hold up the writer.
+     */
+    class SOUNDSTONE_TESTABLE_EXPORT TimingWindow {
+    public:
+        static const uint32_t CAPACITY = 128;
+
+        class Summary {
+        public:
+            // Every run recorded, including those which have left the window.
+            uint64_t count = 0;
+            std::chrono::nanoseconds last {0};
+            // Over the runs still in the window.
+            std::chrono::nanoseconds mean {0};
+            std::chrono::nanoseconds max {0};
+            std::chrono::nanoseconds p99 {0};
+        };
+
+    private:
+        // Odd while a record is being written.
+        std::atomic<uint32_t> _sequence {0};
+        std::atomic<uint64_t> _count {0};
+        std::array<std::atomic<uint32_t>, CAPACITY> _durations;
+
+    public:
+        TimingWindow();
+        TimingWindow(const TimingWindow &) = delete;
+        TimingWindow &operator=(const TimingWindow &) = delete;
+
+        /**
+         * @brief record Add a run, pushing the oldest out of the window. Must only be called from one thread at a
+         *               time. Durations are kept to the nanosecond, up to about four seconds.
+         */
+        void record(std::chrono::nanoseconds duration);
+
+        Summary summarize() const;
+    };
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <soundstone/testable_export.h>
+
+namespace soundstone {
+
+    /**
+     * A fixed capacity double ended queue of work ids. The owning thread pushes and takes from the bottom, while any
+     * other thread may steal from the top.
+     *
+     * The deque does not wrap around. It is meant to be reset before each batch of work, and must have enough
+     * capacity for every push made until the next reset.
+     */
+    class SOUNDSTONE_TESTABLE_EXPORT WorkStealingDeque {
+        std::unique_ptr<std::atomic<uint32_t>[]> _items;
+        uint32_t _capacity = 0;
+        std::atomic<int64_t> _top {0};
+        std::atomic<int64_t> _bottom {0};
+
+    public:
+        static const uint32_t EMPTY = UINT32_MAX;
+
+        void reserve(uint32_t capacity);
+
+        /**
+         * @brief reset Empty the deque. Must not be called while any other thread is using the deque.
+         */
+        void reset();
+
+        /**
+         * @brief push Push an id to the bottom of the deque. Only the owning thread may push.
+         */
+        void push(uint32_t id);
+
+        /**
+         * @brief take Take the most recently pushed id. Only the owning thread may take.
+         * @return The id, or EMPTY if the deque was empty.
+         */
+        uint32_t take();
+
+        /**
+         * @brief steal Take the least recently pushed id from another thread.
+         * @return The id, or EMPTY if the deque was empty or another thread took the id first.
+         */
+        uint32_t steal();
+    };
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <soundstone/export.h>
+#include <soundstone/testable_export.h>
+
+namespace soundstone {
+namespace simd {
+
+    /**
+     * Instruction sets kernels can be run with, from the most widely supported to the least. Every kernel gives the
+     * same result whichever is used.
+     */
+    enum class InstructionSet {
+        SCALAR,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    /**
+     * @brief detect_instruction_set The best instruction set supported by both the CPU and operating system, found
+     *                               with CPUID.
+     */
+    SOUNDSTONE_EXPORT InstructionSet detect_instruction_set();
+
+    /**
+     * @brief instruction_set The instruction set kernels are currently run with. Detected on first use.
+     */
+    SOUNDSTONE_EXPORT InstructionSet instruction_set();
+
+    /**
+     * @brief set_instruction_set Run kernels with another instruction set, for comparing them.
+     * @return False if the instruction set isn't supported, in which case nothing changes.
+     */
+    SOUNDSTONE_EXPORT bool set_instruction_set(InstructionSet instruction_set);
+
+    /**
+     * @brief sum Add the inputs together. Writes silence when there are no inputs.
+     */
+    SOUNDSTONE_EXPORT void sum(const float * const *inputs, uint32_t input_count, float *output, uint32_t count);
+
+    /**
+     * @brief scaled_add Add the input, multiplied by the gain, to the output.
+     */
+    SOUNDSTONE_EXPORT void scaled_add(const float *input, float gain, float *output, uint32_t count);
+
+    /**
+     * @brief gain_ramp Multiply the input by a gain moving linearly from start_gain towards end_gain, reaching it just
+     *                  after the last sample so that a following ramp starting at end_gain carries on smoothly. The
+     *                  input and output may be the same buffer.
+     */
+    SOUNDSTONE_EXPORT void gain_ramp(
+        const float *input, float start_gain, float end_gain, float *output, uint32_t count
+    );
+
+    /**
+     * @brief clamp Limit samples to the range from min to max. The input and output may be the same buffer.
+     */
+    SOUNDSTONE_EXPORT void clamp(const float *input, float min, float max, float *output, uint32_t count);
+
+    /**
+     * Conversions between floats in the range -1 to 1 and signed integers. Floats are scaled by 2^15 or 2^23, rounded
+     * to nearest and saturated, so converting an integer to float and back gives the same integer. 24 bit samples
+     * are held in the low bits of 32 bit integers.
+     */
+    SOUNDSTONE_EXPORT void float_to_int16(const float *input, int16_t *output, uint32_t count);
+    SOUNDSTONE_EXPORT void int16_to_float(const int16_t *input, float *output, uint32_t count);
+    SOUNDSTONE_EXPORT void float_to_int24(const float *input, int32_t *output, uint32_t count);
+    SOUNDSTONE_EXPORT void int24_to_float(const int32_t *input, float *output, uint32_t count);
+
+    /**
+     * @brief interleave Interleave planar channels, each stride samples after the last, into frames.
+     */
+    SOUNDSTONE_EXPORT void interleave(
+        const float *planar, uint32_t stride, uint32_t channel_count, uint32_t frame_count, float *interleaved
+    );
+
+    /**
+     * @brief deinterleave Split frames into planar channels, each stride samples after the last.
+     */
+    SOUNDSTONE_EXPORT void deinterleave(
+        const float *interleaved, uint32_t channel_count, uint32_t frame_count, float *planar, uint32_t stride
+    );
+
+    /**
+     * The kernels built for one instruction set.
+     */
+    class KernelTable {
+    public:
+        void (*sum)(const float * const *inputs, uint32_t input_count, float *output, uint32_t count);
+        void (*scaled_add)(const float *input, float gain, float *output, uint32_t count);
+        void (*gain_ramp)(const float *input, float start_gain, float end_gain, float *output, uint32_t count);
+        void (*clamp)(const float *input, float min, float max, float *output, uint32_t count);
+        void (*float_to_int16)(const float *input, int16_t *output, uint32_t count);
+        void (*int16_to_float)(const int16_t *input, float *output, uint32_t count);
+        void (*float_to_int24)(const float *input, int32_t *output, uint32_t count);
+        void (*int24_to_float)(const int32_t *input, float *output, uint32_t count);
+        void (*interleave)(
+            const float *planar, uint32_t stride, uint32_t channel_count, uint32_t frame_count, float *interleaved
+        );
+        void (*deinterleave)(
+            const float *interleaved, uint32_t channel_count, uint32_t frame_count, float *planar, uint32_t stride
+        );
+    };
+
+    /**
+     * @brief kernel_table The kernels for an instruction set, or null if it isn't supported by this build or CPU.
+     */
+    SOUNDSTONE_TESTABLE_EXPORT const KernelTable *kernel_table(InstructionSet instruction_set);
+}
+}
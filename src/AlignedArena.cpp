@@ -0,0 +1,38 @@
+#include <soundstone/AlignedArena.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+using namespace soundstone;
+using namespace std;
+
+const size_t AlignedArena::ALIGNMENT;
+const size_t AlignedArena::FLOATS_PER_ALIGNMENT;
+
+size_t AlignedArena::reserve(size_t float_count) {
+    assert(_data == nullptr);
+    size_t offset = _size;
+    size_t padded_count = (float_count + FLOATS_PER_ALIGNMENT - 1) / FLOATS_PER_ALIGNMENT * FLOATS_PER_ALIGNMENT;
+    _size += padded_count;
+    return offset;
+}
+
+void AlignedArena::allocate() {
+    // Over-allocate by one alignment so the start can be moved up to the next boundary.
+    size_t byte_count = _size * sizeof(float) + ALIGNMENT;
+    _memory = unique_ptr<char[]>(new char[byte_count]);
+
+    uintptr_t address = reinterpret_cast<uintptr_t>(_memory.get());
+    uintptr_t aligned_address = (address + ALIGNMENT - 1) & ~static_cast<uintptr_t>(ALIGNMENT - 1);
+    _data = reinterpret_cast<float *>(aligned_address);
+    fill_n(_data, _size, 0.0f);
+}
+
+float *AlignedArena::at(size_t offset) const {
+    assert(_data != nullptr && offset <= _size);
+    return _data + offset;
+}
+
+size_t AlignedArena::size() const {
+    return _size;
+}
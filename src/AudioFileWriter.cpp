@@ -0,0 +1,198 @@
+#include <soundstone/AudioFileWriter.hpp>
+#include <soundstone/simd/Kernels.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace soundstone;
+using namespace std;
+
+const uint32_t AudioFileWriter::BUFFER_FRAMES;
+
+namespace {
+    // Offsets into the WAV header of the fields only known once every frame has been written.
+    const long WAV_RIFF_SIZE_OFFSET = 4;
+    const long WAV_FACT_FRAMES_OFFSET = 46;
+    const long WAV_DATA_SIZE_OFFSET = 54;
+    const uint32_t WAV_HEADER_SIZE = 58;
+    const uint16_t WAV_FORMAT_IEEE_FLOAT = 3;
+
+    bool is_little_endian() {
+        const uint32_t value = 1;
+        unsigned char first_byte;
+        memcpy(&first_byte, &value, 1);
+        return first_byte == 1;
+    }
+
+    void put_uint16(unsigned char *bytes, uint16_t value) {
+        bytes[0] = static_cast<unsigned char>(value);
+        bytes[1] = static_cast<unsigned char>(value >> 8);
+    }
+
+    void put_uint32(unsigned char *bytes, uint32_t value) {
+        put_uint16(bytes, static_cast<uint16_t>(value));
+        put_uint16(bytes + 2, static_cast<uint16_t>(value >> 16));
+    }
+
+    uint32_t clamp_to_uint32(uint64_t value) {
+        return static_cast<uint32_t>(min<uint64_t>(value, numeric_limits<uint32_t>::max()));
+    }
+}
+
+AudioFileWriter::~AudioFileWriter() {
+    close();
+}
+
+bool AudioFileWriter::open(const std::string &path, Format format, uint32_t channel_count, uint32_t sample_rate) {
+    close();
+    if (channel_count == 0) {
+        return false;
+    }
+
+    _file = fopen(path.c_str(), "wb");
+    if (_file == nullptr) {
+        return false;
+    }
+
+    _format = format;
+    _channel_count = channel_count;
+    _sample_rate = sample_rate;
+    _frame_count = 0;
+    _has_failed = false;
+    _buffer = unique_ptr<float[]>(new float[static_cast<size_t>(BUFFER_FRAMES) * channel_count]);
+    _buffered_frame_count = 0;
+
+    if (_format == Format::WAV) {
+        write_header();
+    }
+    return true;
+}
+
+bool AudioFileWriter::close() {
+    if (_file == nullptr) {
+        return false;
+    }
+
+    flush();
+    if (_format == Format::WAV) {
+        write_header();
+    }
+    if (fclose(_file) != 0) {
+        _has_failed = true;
+    }
+
+    _file = nullptr;
+    _buffer.reset();
+    return !_has_failed;
+}
+
+void AudioFileWriter::write(const float *frames, uint32_t frame_count) {
+    if (_file == nullptr) {
+        return;
+    }
+
+    while (frame_count > 0) {
+        uint32_t count = min(frame_count, BUFFER_FRAMES - _buffered_frame_count);
+        copy_n(
+            frames,
+            static_cast<size_t>(count) * _channel_count,
+            _buffer.get() + static_cast<size_t>(_buffered_frame_count) * _channel_count
+        );
+        _buffered_frame_count += count;
+        _frame_count += count;
+        frames += static_cast<size_t>(count) * _channel_count;
+        frame_count -= count;
+
+        if (_buffered_frame_count == BUFFER_FRAMES) {
+            flush();
+        }
+    }
+}
+
+void AudioFileWriter::write_planar(const float *planar, uint32_t stride, uint32_t frame_count) {
+    if (_file == nullptr) {
+        return;
+    }
+
+    uint32_t offset = 0;
+    while (offset < frame_count) {
+        uint32_t count = min(frame_count - offset, BUFFER_FRAMES - _buffered_frame_count);
+        simd::interleave(
+            planar + offset, stride, _channel_count, count,
+            _buffer.get() + static_cast<size_t>(_buffered_frame_count) * _channel_count
+        );
+        _buffered_frame_count += count;
+        _frame_count += count;
+        offset += count;
+
+        if (_buffered_frame_count == BUFFER_FRAMES) {
+            flush();
+        }
+    }
+}
+
+void AudioFileWriter::flush() {
+    size_t sample_count = static_cast<size_t>(_buffered_frame_count) * _channel_count;
+    _buffered_frame_count = 0;
+
+    // Files are always little-endian, so samples are only byte-swapped on big-endian hosts.
+    if (!is_little_endian()) {
+        for (size_t i = 0; i < sample_count; ++i) {
+            uint32_t bits;
+            memcpy(&bits, &_buffer[i], sizeof(bits));
+            put_uint32(reinterpret_cast<unsigned char *>(&_buffer[i]), bits);
+        }
+    }
+
+    if (fwrite(_buffer.get(), sizeof(float), sample_count, _file) != sample_count) {
+        _has_failed = true;
+    }
+}
+
+void AudioFileWriter::write_header() {
+    uint64_t data_size = _frame_count * _channel_count * sizeof(float);
+    uint16_t block_align = static_cast<uint16_t>(_channel_count * sizeof(float));
+
+    unsigned char header[WAV_HEADER_SIZE];
+    memcpy(header, "RIFF", 4);
+    put_uint32(header + WAV_RIFF_SIZE_OFFSET, clamp_to_uint32(data_size + WAV_HEADER_SIZE - 8));
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put_uint32(header + 16, 18);
+    put_uint16(header + 20, WAV_FORMAT_IEEE_FLOAT);
+    put_uint16(header + 22, static_cast<uint16_t>(_channel_count));
+    put_uint32(header + 24, _sample_rate);
+    put_uint32(header + 28, _sample_rate * block_align);
+    put_uint16(header + 32, block_align);
+    put_uint16(header + 34, 32);
+    put_uint16(header + 36, 0);
+    memcpy(header + 38, "fact", 4);
+    put_uint32(header + 42, 4);
+    put_uint32(header + WAV_FACT_FRAMES_OFFSET, clamp_to_uint32(_frame_count));
+    memcpy(header + 50, "data", 4);
+    put_uint32(header + WAV_DATA_SIZE_OFFSET, clamp_to_uint32(data_size));
+
+    // Written once up front to reserve the space, and again over the top once the sizes are known.
+    long position = ftell(_file);
+    if (fseek(_file, 0, SEEK_SET) != 0 || fwrite(header, 1, WAV_HEADER_SIZE, _file) != WAV_HEADER_SIZE) {
+        _has_failed = true;
+    }
+    if (position > 0 && fseek(_file, position, SEEK_SET) != 0) {
+        _has_failed = true;
+    }
+}
+
+bool AudioFileWriter::is_open() const {
+    return _file != nullptr;
+}
+
+uint32_t AudioFileWriter::channel_count() const {
+    return _channel_count;
+}
+
+uint32_t AudioFileWriter::sample_rate() const {
+    return _sample_rate;
+}
+
+uint64_t AudioFileWriter::frame_count() const {
+    return _frame_count;
+}
@@ -1,6 +1,10 @@
 #include <soundstone/AudioProcessor.hpp>
+#include <soundstone/CriticalPath.hpp>
+#include <soundstone/simd/Kernels.hpp>
 #include <stack>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <iostream>
 
 using namespace soundstone;
@@ -12,136 +16,657 @@ AudioProcessor::RoutePredicate::RoutePredicate(soundstone::AudioProcessor *proce
     _source = source;
 }
 
-void AudioProcessor::RoutePredicate::to(soundstone::Module *destination, uint32_t index) {
-    _processor->set_input(destination, index, _source);
+bool AudioProcessor::RoutePredicate::to(soundstone::Module *destination, uint32_t index) {
+    return _processor->set_input(destination, index, _source);
 }
 
-void AudioProcessor::add_module(Module *module) {
-    lock_guard<mutex> lock(_actions_mutex);
-    AddRemoveData data;
-    data.module = module;
-    Action action = { ActionType::ADD_MODULE, { data } };
-    _actions.push(action);
+bool AudioProcessor::RoutePredicate::mix_into(soundstone::Module *destination, uint32_t index, float gain) {
+    return _processor->mix_input(destination, index, _source, gain);
 }
 
-void AudioProcessor::remove_module(Module *module) {
-    lock_guard<mutex> lock(_actions_mutex);
-    AddRemoveData data;
-    data.module = module;
-    Action action = { ActionType::REMOVE_MODULE, { data } };
-    _actions.push(action);
+static_assert(
+    Module::BUFFER_ALIGNMENT == AlignedArena::ALIGNMENT && Module::BUFFER_PADDING == AlignedArena::FLOATS_PER_ALIGNMENT,
+    "Arena buffers must be aligned and padded the way modules are promised"
+);
+
+#ifdef SOUNDSTONE_MODULE_STATS
+// How often the builder checks whether measured costs have moved far enough from the ones the current snapshot was
+// prioritized with to rebuild it. Changes smaller than the minimum drift are never worth a rebuild.
+static const chrono::milliseconds COST_CHECK_INTERVAL(500);
+static const uint64_t MIN_COST_DRIFT = 1000;
+#endif
+
+const uint32_t AudioProcessor::DEFAULT_ACTION_CAPACITY;
+const uint32_t AudioProcessor::DEFAULT_BLOCK_SIZE;
+
+AudioProcessor::AudioProcessor(uint32_t action_capacity)
+    : _actions(action_capacity)
+{
+    _builder_thread = thread(&AudioProcessor::builder_routine, this);
 }
 
-void AudioProcessor::set_input(Module *module, uint32_t index, Module *input) {
-    assert(index < MAX_MODULE_INPUTS);
-    lock_guard<mutex> lock(_actions_mutex);
+AudioProcessor::~AudioProcessor() {
+    _builder_should_quit.store(true, memory_order_relaxed);
+    wake_builder();
+    _builder_thread.join();
+
+    // Workers may still be on their way out of the last call, looking at the current snapshot's work.
+    _party.setup(0, _wait_policy, _thread_config);
+
+    delete_retired_snapshots();
+    delete _previous_snapshot;
+    delete _snapshot;
+    delete _pending_snapshot.load(memory_order_acquire);
+}
+
+bool AudioProcessor::add_module(Module *module) {
+    Action action;
+    action.type = ActionType::ADD_MODULE;
+    action.data.add_remove.module = module;
+    return queue_action(action);
+}
+
+bool AudioProcessor::remove_module(Module *module) {
+    Action action;
+    action.type = ActionType::REMOVE_MODULE;
+    action.data.add_remove.module = module;
+    return queue_action(action);
+}
+
+bool AudioProcessor::set_input(Module *module, uint32_t index, Module *input) {
+    RouteData data;
+    data.source = input;
+    data.dest = module;
+    data.index = index;
+    Action action;
+    action.type = ActionType::ROUTE_MODULE;
+    action.data.route = data;
+    return queue_action(action);
+}
+
+bool AudioProcessor::mix_input(Module *module, uint32_t index, Module *input, float gain) {
     RouteData data;
     data.source = input;
     data.dest = module;
     data.index = index;
-    ActionData action_data = {};
-    action_data.route = data;
-    Action action = { ActionType::ROUTE_MODULE, action_data };
-    _actions.push(action);
+    data.gain = gain;
+    Action action;
+    action.type = ActionType::MIX_MODULE;
+    action.data.route = data;
+    return queue_action(action);
+}
+
+bool AudioProcessor::unmix_input(Module *module, uint32_t index, Module *input) {
+    RouteData data;
+    data.source = input;
+    data.dest = module;
+    data.index = index;
+    Action action;
+    action.type = ActionType::UNMIX_MODULE;
+    action.data.route = data;
+    return queue_action(action);
 }
 
 AudioProcessor::RoutePredicate AudioProcessor::route(soundstone::Module *module) {
     return RoutePredicate(this, module);
 }
 
+uint64_t AudioProcessor::cyclic_route_count() const {
+    return _cyclic_route_count.load(memory_order_relaxed);
+}
+
+bool AudioProcessor::queue_action(const Action &action) {
+    if (!_actions.push(action)) {
+        return false;
+    }
+    wake_builder();
+    return true;
+}
+
+void AudioProcessor::wait_for_changes() {
+    size_t action_count = _actions.push_count();
+    uint32_t thread_count = _thread_count.load(memory_order_relaxed);
+    uint32_t block_size = _block_size.load(memory_order_relaxed);
+    PoolParty::Scheduler scheduler = _scheduler.load(memory_order_relaxed);
+    wake_builder();
+
+    unique_lock<mutex> lock(_builder_mutex);
+    while (_built_action_count < action_count
+        || _built_thread_count != thread_count
+        || _built_block_size != block_size
+        || _built_scheduler != scheduler
+    ) {
+        _built_condition.wait(lock);
+    }
+}
+
 void AudioProcessor::update(uint32_t nsamples) {
-    process_actions();
+    // Pick up the newest snapshot, if one has been built since the last update.
+    Snapshot *next_snapshot = _pending_snapshot.exchange(nullptr, memory_order_acq_rel);
+    if (next_snapshot != nullptr) {
+        if (_previous_snapshot == nullptr) {
+            _previous_snapshot = _snapshot;
+        } else {
+            // The pool party never ran the current snapshot, so nothing can be looking at it.
+            retire_snapshot(_snapshot);
+        }
+        _snapshot = next_snapshot;
+    }
 
-    if (_dependency_indices_are_dirty) {
-        _dependency_indices.clear();
-        _dependency_indices.reserve(_harnesses.size());
+    if (_snapshot == nullptr) {
+        return;
+    }
 
-        for (uint32_t i = 0, ilen = _harnesses.size(); i < ilen; ++i) {
-            vector<uint32_t> indices_vector;
-            for (Module *sampler : _harnesses[i].inputs) {
-                if (sampler != nullptr) {
-                    indices_vector.push_back(_modules_to_harnesses[sampler]);
-                }
+    // Notify all samplers to commit settings
+    for (PlanNode &node : _snapshot->plan) {
+        node.module->commit();
+    }
+
+    // The pool party's threads may be restarting, in which case this update does without it rather than wait.
+    // Every snapshot is safe to run in plan order, which is what the pool party would do with a single thread anyway.
+    unique_lock<mutex> party_lock(_party_mutex, try_to_lock);
+    bool uses_party = party_lock.owns_lock() && !_snapshot->runs_in_plan_order;
+
+    // Workers only look at the work set they were last given. Once the party has run the current snapshot, or has
+    // no workers left, none of them look at the previous one anymore.
+    bool can_retire_previous = party_lock.owns_lock() && (uses_party || _party.worker_count() == 0);
+
+    // Do the work one block at a time, as the buffers only hold a block.
+    while (nsamples > 0) {
+        uint32_t block_nsamples = min(nsamples, _snapshot->block_size);
+        _snapshot->nsamples = block_nsamples;
+        if (uses_party) {
+            _party.work(_snapshot->work);
+        } else {
+            for (PlanNode &node : _snapshot->plan) {
+                run_node(node, block_nsamples);
             }
+        }
+        nsamples -= block_nsamples;
+
+        if (_previous_snapshot != nullptr && can_retire_previous) {
+            retire_snapshot(_previous_snapshot);
+            _previous_snapshot = nullptr;
+        }
+    }
+}
+
+void AudioProcessor::retire_snapshot(Snapshot *snapshot) {
+    // Only the audio thread pushes, and the builder thread only ever takes the whole list, so there's no ABA problem.
+    Snapshot *head = _retired_snapshots.load(memory_order_relaxed);
+    do {
+        snapshot->next_retired = head;
+    } while (!_retired_snapshots.compare_exchange_weak(head, snapshot, memory_order_release, memory_order_relaxed));
+}
 
-            auto indices = unique_ptr<uint32_t[]>(new uint32_t[indices_vector.size()]);
-            copy_n(indices_vector.data(), indices_vector.size(), indices.get());
+void AudioProcessor::delete_retired_snapshots() {
+    Snapshot *snapshot = _retired_snapshots.exchange(nullptr, memory_order_acquire);
+    while (snapshot != nullptr) {
+        Snapshot *next = snapshot->next_retired;
+        delete snapshot;
+        snapshot = next;
+    }
+}
+
+void AudioProcessor::publish_snapshot(Snapshot *snapshot) {
+    Snapshot *unused_snapshot = _pending_snapshot.exchange(snapshot, memory_order_acq_rel);
+
+    // The audio thread never saw a snapshot that's replaced before it was picked up.
+    delete unused_snapshot;
+}
+
+void AudioProcessor::wake_builder() {
+    _builder_epoch.fetch_add(1, memory_order_seq_cst);
+    if (_builder_is_waiting.load(memory_order_seq_cst)) {
+        lock_guard<mutex> lock(_builder_mutex);
+        _builder_condition.notify_one();
+    }
+}
+
+void AudioProcessor::builder_routine() {
+    bool should_reprioritize = false;
+    while (true) {
+        // The epoch is read before looking for changes, so changes queued after this point wake the builder again.
+        uint32_t epoch = _builder_epoch.load(memory_order_seq_cst);
+        if (_builder_should_quit.load(memory_order_relaxed)) {
+            break;
+        }
+
+        delete_retired_snapshots();
+
+        uint32_t thread_count = _thread_count.load(memory_order_relaxed);
+        uint32_t block_size = _block_size.load(memory_order_relaxed);
+        PoolParty::Scheduler scheduler = _scheduler.load(memory_order_relaxed);
+        bool has_changed = process_actions();
+        if (has_changed
+            || should_reprioritize
+            || thread_count != _built_thread_count
+            || block_size != _built_block_size
+            || scheduler != _built_scheduler
+        ) {
+            publish_snapshot(build_snapshot(thread_count, block_size, scheduler));
+        }
 
-            _dependency_indices.emplace_back(move(indices), indices_vector.size());
+        { lock_guard<mutex> lock(_builder_mutex);
+            _built_action_count = _actions.pop_count();
+            _built_thread_count = thread_count;
+            _built_block_size = block_size;
+            _built_scheduler = scheduler;
+            _built_condition.notify_all();
         }
 
-        _dependency_indices_are_dirty = false;
+        // Registering as waiting before re-reading the epoch (both sequentially consistent) means wake_builder either
+        // sees the builder waiting or the builder sees the new epoch.
+        unique_lock<mutex> lock(_builder_mutex);
+        _builder_is_waiting.store(true, memory_order_seq_cst);
+        should_reprioritize = false;
+        while (_builder_epoch.load(memory_order_seq_cst) == epoch) {
+#ifdef SOUNDSTONE_MODULE_STATS
+            // Priorities follow measured costs, so look in on them every so often while there's nothing else to do.
+            if (_builder_condition.wait_for(lock, COST_CHECK_INTERVAL) == cv_status::timeout) {
+                lock.unlock();
+                should_reprioritize = costs_have_drifted();
+                lock.lock();
+                if (should_reprioritize) {
+                    break;
+                }
+            }
+#else
+            _builder_condition.wait(lock);
+#endif
+        }
+        _builder_is_waiting.store(false, memory_order_relaxed);
     }
+}
 
-    // Make sure existing module buffers are big enough
-    if (_sampler_buffer_length < nsamples) {
-        _sampler_buffers.clear();
-        _sampler_buffer_length = nsamples;
-        _null_sample_buffer = unique_ptr<float[]>(new float[nsamples]{0});
+AudioProcessor::Snapshot *AudioProcessor::build_snapshot(
+    uint32_t thread_count, uint32_t block_size, PoolParty::Scheduler scheduler
+) {
+    uint32_t harness_count = _harnesses.size();
+    Snapshot *snapshot = new Snapshot();
+
+    // Order harnesses so that every module comes after the modules routed into it. Routes that would create a cycle
+    // are never added to the graph, so it always resolves.
+    uint32_t resolved_count;
+    unique_ptr<Module *[]> resolved = _graph.resolve(resolved_count);
+    assert(resolved != nullptr && resolved_count == harness_count);
+
+    vector<uint32_t> order(harness_count);
+    vector<uint32_t> plan_indices(harness_count);
+    for (uint32_t i = 0; i < harness_count; ++i) {
+        order[i] = _modules_to_harnesses[resolved[i]];
+        plan_indices[order[i]] = i;
     }
 
-    // Create new buffers if needed
-    while (_sampler_buffers.size() < _harnesses.size()) {
-        _sampler_buffers.emplace_back(new float[nsamples]);
+    // Find the nodes each node reads from.
+    vector<PlanNode> &plan = snapshot->plan;
+    plan.resize(harness_count);
+    _plan_dependencies.resize(harness_count);
+    uint32_t max_channel_count = 1;
+    size_t total_input_count = 0;
+    size_t total_routed_input_count = 0;
+    for (uint32_t i = 0; i < harness_count; ++i) {
+        ModuleHarness &harness = _harnesses[order[i]];
+        PlanNode &node = plan[i];
+        node.module = harness.module;
+        node.channel_count = harness.module->channel_count();
+        node.preserves_silence = harness.module->preserves_silence();
+        node.input_count = harness.inputs.size();
+        assert(node.channel_count > 0);
+        max_channel_count = max(max_channel_count, node.channel_count);
+        total_input_count += node.input_count;
+
+        vector<uint32_t> &dependencies = _plan_dependencies[i];
+        dependencies.clear();
+        for (uint32_t input_index = 0; input_index < node.input_count; ++input_index) {
+            // Unrouted inputs read from the null buffer, which needs as many channels as any input expects.
+            max_channel_count = max(max_channel_count, harness.module->input_channel_count(input_index));
+
+            for (const Route &route : harness.inputs[input_index]) {
+                auto input_it = _modules_to_harnesses.find(route.source);
+                if (input_it != _modules_to_harnesses.end()) {
+                    dependencies.push_back(plan_indices[input_it->second]);
+                }
+            }
+        }
+        total_routed_input_count += dependencies.size();
     }
 
-    // Ensure input vectors are allocated
-    while (_input_vectors.size() < _harnesses.size()) {
-        _input_vectors.emplace_back();
+    // Share buffers between nodes whose outputs are never needed at the same time. When nodes run on more than one
+    // thread, a buffer is only reused by nodes guaranteed to run after everything reading it.
+    BufferLiveness::Mode mode = thread_count > 1
+        ? BufferLiveness::Mode::CONCURRENT
+        : BufferLiveness::Mode::SEQUENTIAL;
+    vector<uint32_t> buffer_indices;
+    uint32_t buffer_count = _buffer_liveness.assign(_plan_dependencies, mode, buffer_indices);
+    snapshot->runs_in_plan_order = mode == BufferLiveness::Mode::SEQUENTIAL;
+
+    // A shared buffer needs room for the most channels of any node using it.
+    vector<uint32_t> buffer_channel_counts(buffer_count, 1);
+    for (uint32_t i = 0; i < harness_count; ++i) {
+        uint32_t &channel_count = buffer_channel_counts[buffer_indices[i]];
+        channel_count = max(channel_count, plan[i].channel_count);
     }
 
-    // Notify all samplers to commit settings
-    for (ModuleHarness &harness : _harnesses) {
-        harness.module->commit();
-    }
-
-    // Set up all worker functions.
-    for (size_t i = 0, ilen = _harnesses.size(); i < ilen; ++i) {
-        ModuleHarness &harness = _harnesses[i];
-        Module *sampler = harness.module;
-
-        array<const float *, MAX_MODULE_INPUTS> &input_vector = _input_vectors[i];
-        const float * const *sampler_inputs = input_vector.data();
-        float *output_buffer = _sampler_buffers[i].get();
-
-        for (uint32_t input_index = 0; input_index < MAX_MODULE_INPUTS; ++input_index) {
-            Module *input_sampler = harness.inputs[input_index];
-            const float *input_buffer;
-            if (input_sampler == nullptr) {
-                input_buffer = _null_sample_buffer.get();
-            } else {
-                uint32_t sampler_index = _modules_to_harnesses[input_sampler];
-                input_buffer = _sampler_buffers[sampler_index].get();
+    // Every buffer lives in one arena, so the whole graph's scratch memory is a single aligned block. Offsets are
+    // reserved first and turned into pointers once the arena is allocated.
+    AlignedArena &arena = snapshot->arena;
+    snapshot->block_size = block_size;
+    size_t null_offset = arena.reserve(block_size * max_channel_count);
+    vector<size_t> buffer_offsets(buffer_count);
+    for (uint32_t i = 0; i < buffer_count; ++i) {
+        buffer_offsets[i] = arena.reserve(block_size * buffer_channel_counts[i]);
+    }
+
+    // Routes from modules which have been added, found for one input at a time.
+    vector<pair<uint32_t, float>> routes;
+    auto find_routes = [&](const ModuleHarness &harness, uint32_t input_index) {
+        routes.clear();
+        for (const Route &route : harness.inputs[input_index]) {
+            auto input_it = _modules_to_harnesses.find(route.source);
+            if (input_it != _modules_to_harnesses.end()) {
+                routes.emplace_back(plan_indices[input_it->second], route.gain);
+            }
+        }
+    };
+    // Only a single route at unity gain from a module with the expected number of channels can be read directly.
+    auto needs_mix = [&](uint32_t expected_channel_count) {
+        return routes.size() > 1 || (routes.size() == 1
+            && (routes[0].second != 1.0f || plan[routes[0].first].channel_count != expected_channel_count));
+    };
+
+    // Inputs which can't be read directly are mixed into a buffer of their own.
+    vector<size_t> mix_offsets;
+    for (uint32_t i = 0; i < harness_count; ++i) {
+        ModuleHarness &harness = _harnesses[order[i]];
+        for (uint32_t input_index = 0; input_index < plan[i].input_count; ++input_index) {
+            uint32_t expected_channel_count = harness.module->input_channel_count(input_index);
+            assert(expected_channel_count > 0);
+            find_routes(harness, input_index);
+            if (needs_mix(expected_channel_count)) {
+                mix_offsets.push_back(arena.reserve(block_size * expected_channel_count));
             }
-            input_vector[input_index] = input_buffer;
         }
+    }
+    arena.allocate();
+    snapshot->null_buffer = arena.at(null_offset);
+
+    // Inputs are sliced out of lists covering every node, which must not grow once slices point into them.
+    snapshot->input_buffers.resize(total_input_count);
+    snapshot->silent_inputs = unique_ptr<bool[]>(new bool[total_input_count]);
+    snapshot->routed_inputs.reserve(total_routed_input_count);
+
+    // Resolve the buffers used by each node, mixed inputs being met in the same order as above.
+    uint32_t mix_index = 0;
+    size_t input_offset = 0;
+    for (uint32_t i = 0; i < harness_count; ++i) {
+        ModuleHarness &harness = _harnesses[order[i]];
+        PlanNode &node = plan[i];
+        node.output = arena.at(buffer_offsets[buffer_indices[i]]);
+        node.inputs = snapshot->input_buffers.data() + input_offset;
+        node.silent_inputs = snapshot->silent_inputs.get() + input_offset;
+        node.routed_inputs = snapshot->routed_inputs.data() + snapshot->routed_inputs.size();
+        input_offset += node.input_count;
+
+        for (uint32_t input_index = 0; input_index < node.input_count; ++input_index) {
+            find_routes(harness, input_index);
+            if (routes.empty()) {
+                // Not routed, or routed from modules that haven't been added.
+                node.inputs[input_index] = snapshot->null_buffer;
+                node.silent_inputs[input_index] = true;
+                continue;
+            }
 
-        unique_ptr<uint32_t[]> &indices = _dependency_indices[i].first;
-        uint32_t index_count = _dependency_indices[i].second;
+            node.silent_inputs[input_index] = false;
+            for (uint32_t route_index = 0; route_index < routes.size(); ++route_index) {
+                PlanNode::RoutedInput routed_input;
+                routed_input.index = input_index;
+                routed_input.is_first_into_input = route_index == 0;
+                routed_input.source_is_silent = &plan[routes[route_index].first].output_is_silent;
+                snapshot->routed_inputs.push_back(routed_input);
+                ++node.routed_input_count;
+            }
 
-        _party.add_work(
-            [=]{sampler->sample(sampler_inputs, output_buffer, nsamples);},
-            indices.get(), index_count
+            uint32_t expected_channel_count = harness.module->input_channel_count(input_index);
+            if (!needs_mix(expected_channel_count)) {
+                node.inputs[input_index] = arena.at(buffer_offsets[buffer_indices[routes[0].first]]);
+                continue;
+            }
+
+            PlanNode::InputMix mix;
+            mix.destination = arena.at(mix_offsets[mix_index++]);
+            mix.destination_channel_count = expected_channel_count;
+            for (const pair<uint32_t, float> &route : routes) {
+                const PlanNode &input_node = plan[route.first];
+                PlanNode::MixSource source;
+                source.buffer = arena.at(buffer_offsets[buffer_indices[route.first]]);
+                source.channel_count = input_node.channel_count;
+                source.gain = route.second;
+                source.is_silent = &input_node.output_is_silent;
+                mix.sources.push_back(source);
+            }
+            node.inputs[input_index] = mix.destination;
+            node.mixes.push_back(move(mix));
+        }
+        node.dependencies = _plan_dependencies[i];
+        node.timing = harness.timing;
+    }
+
+    // Snapshots run in plan order never go through the pool party.
+    if (snapshot->runs_in_plan_order) {
+        return snapshot;
+    }
+
+    // Rank each node by the cost of the longest path from it to the end of the graph, so that work on the critical
+    // path is picked up ahead of work which can wait.
+    vector<uint64_t> costs;
+    vector<uint64_t> priorities;
+    measure_costs(order, costs);
+    CriticalPath::measure(_plan_dependencies, costs, priorities);
+
+    // Set up all worker functions, and prepare them for the pool party so the audio thread doesn't have to.
+    for (uint32_t i = 0; i < harness_count; ++i) {
+        PlanNode &node = plan[i];
+        PlanNode *node_ptr = &node;
+        snapshot->work.add_work(
+            [snapshot, node_ptr]{ run_node(*node_ptr, snapshot->nsamples); },
+            node.dependencies.data(), node.dependencies.size(), priorities[i]
         );
     }
+    snapshot->work.prepare(thread_count - 1, scheduler);
+
+    return snapshot;
+}
 
-    // Do the work.
-    _party.work();
+void AudioProcessor::measure_costs(const vector<uint32_t> &order, vector<uint64_t> &costs) {
+    // Nodes cost what they took on average over the last blocks they were timed for. Without timing, none of them
+    // are measured, which has every node cost the same.
+    costs.assign(order.size(), 0);
+#ifdef SOUNDSTONE_MODULE_STATS
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        ModuleHarness &harness = _harnesses[order[i]];
+        TimingWindow::Summary summary = harness.timing->summarize();
+        harness.scheduled_cost = summary.count > 0 ? max<uint64_t>(summary.mean.count(), 1) : 0;
+        costs[i] = harness.scheduled_cost;
+    }
+#endif
+}
+
+bool AudioProcessor::costs_have_drifted() const {
+#ifdef SOUNDSTONE_MODULE_STATS
+    // Priorities only decide anything when there's more than one thread to hand work to.
+    if (_built_thread_count <= 1) {
+        return false;
+    }
+    for (const ModuleHarness &harness : _harnesses) {
+        TimingWindow::Summary summary = harness.timing->summarize();
+        if (summary.count == 0) {
+            continue;
+        }
+        uint64_t cost = max<uint64_t>(summary.mean.count(), 1);
+        uint64_t drift = cost > harness.scheduled_cost ? cost - harness.scheduled_cost : harness.scheduled_cost - cost;
+        // A quarter either way of what the snapshot was built with.
+        if (harness.scheduled_cost == 0 || (drift > MIN_COST_DRIFT && drift * 4 > harness.scheduled_cost)) {
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+void AudioProcessor::run_node(PlanNode &node, uint32_t nsamples) {
+#ifdef SOUNDSTONE_MODULE_STATS
+    chrono::steady_clock::time_point start_time = chrono::steady_clock::now();
+    sample_node(node, nsamples);
+    node.timing->record(chrono::steady_clock::now() - start_time);
+#else
+    sample_node(node, nsamples);
+#endif
+}
+
+void AudioProcessor::sample_node(PlanNode &node, uint32_t nsamples) {
+    // Unrouted inputs were marked silent when the plan was built, so only routed ones need looking at. An input
+    // summing several routes is silent when all of them are.
+    bool all_inputs_are_silent = true;
+    for (uint32_t i = 0; i < node.routed_input_count; ++i) {
+        const PlanNode::RoutedInput &routed_input = node.routed_inputs[i];
+        bool is_silent = *routed_input.source_is_silent;
+        bool &input_is_silent = node.silent_inputs[routed_input.index];
+        input_is_silent = is_silent && (routed_input.is_first_into_input || input_is_silent);
+        all_inputs_are_silent = all_inputs_are_silent && is_silent;
+    }
+
+    if (all_inputs_are_silent && node.preserves_silence) {
+        fill_n(node.output, node.channel_count * nsamples, 0.0f);
+        node.output_is_silent = true;
+        return;
+    }
+
+    for (const PlanNode::InputMix &mix : node.mixes) {
+        run_mix(mix, nsamples);
+    }
+
+    node.output_is_silent = node.module->sample_with_silence(
+        node.inputs, node.silent_inputs, node.output, nsamples
+    );
+}
+
+namespace {
+    // Write the first source into a buffer, then add the rest to it.
+    void accumulate(const float *source, float gain, float *destination, uint32_t nsamples, bool &is_written) {
+        if (is_written) {
+            simd::scaled_add(source, gain, destination, nsamples);
+        } else if (gain == 1.0f) {
+            copy_n(source, nsamples, destination);
+        } else {
+            simd::gain_ramp(source, gain, gain, destination, nsamples);
+        }
+        is_written = true;
+    }
+}
+
+void AudioProcessor::run_mix(const PlanNode::InputMix &mix, uint32_t nsamples) {
+    uint32_t destination_channel_count = mix.destination_channel_count;
+    for (uint32_t channel = 0; channel < destination_channel_count; ++channel) {
+        float *destination = mix.destination + channel * nsamples;
+        bool is_written = false;
+
+        for (const PlanNode::MixSource &source : mix.sources) {
+            if (*source.is_silent) {
+                // Adds nothing.
+                continue;
+            }
+
+            uint32_t source_channel_count = source.channel_count;
+            if (destination_channel_count == 1 && source_channel_count > 1) {
+                // Mix down to mono.
+                float gain = source.gain / static_cast<float>(source_channel_count);
+                for (uint32_t source_channel = 0; source_channel < source_channel_count; ++source_channel) {
+                    accumulate(source.buffer + source_channel * nsamples, gain, destination, nsamples, is_written);
+                }
+            } else if (source_channel_count == 1) {
+                // Mono is copied to every channel.
+                accumulate(source.buffer, source.gain, destination, nsamples, is_written);
+            } else if (channel < source_channel_count) {
+                accumulate(source.buffer + channel * nsamples, source.gain, destination, nsamples, is_written);
+            }
+        }
+
+        if (!is_written) {
+            fill_n(destination, nsamples, 0.0f);
+        }
+    }
 }
 
 void AudioProcessor::set_thread_count(uint32_t count) {
     assert(count > 0);
-    _party.setup(count);
+    { lock_guard<mutex> lock(_party_mutex);
+        _thread_count.store(count, memory_order_relaxed);
+        // The thread calling update does work too.
+        _party.setup(count - 1, _wait_policy, _thread_config);
+    }
+
+    // Buffers are shared differently when modules run concurrently, so the current snapshot may not be safe to run
+    // on the new number of threads. Make sure the next update picks up one that is.
+    wait_for_changes();
 }
 
+uint32_t AudioProcessor::thread_count() const {
+    return _thread_count.load(memory_order_relaxed);
+}
 
-void AudioProcessor::process_actions() {
-    lock_guard<mutex> lock(_actions_mutex);
+void AudioProcessor::set_block_size(uint32_t block_size) {
+    assert(block_size > 0);
+    // Keeps every channel of a full block aligned.
+    uint32_t padding = Module::BUFFER_PADDING;
+    uint32_t padded_block_size = (block_size + padding - 1) / padding * padding;
+    _block_size.store(padded_block_size, memory_order_relaxed);
+    wait_for_changes();
+}
 
-    while (!_actions.empty()) {
-        Action action = _actions.front();
-        _actions.pop();
+void AudioProcessor::set_wait_policy(const PoolParty::WaitPolicy &policy) {
+    lock_guard<mutex> lock(_party_mutex);
+    _wait_policy = policy;
+    _party.setup(_thread_count.load(memory_order_relaxed) - 1, _wait_policy, _thread_config);
+}
+
+void AudioProcessor::set_thread_config(const ThreadConfig &config) {
+    lock_guard<mutex> lock(_party_mutex);
+    _thread_config = config;
+    _party.setup(_thread_count.load(memory_order_relaxed) - 1, _wait_policy, _thread_config);
+}
+
+vector<ThreadConfig::Report> AudioProcessor::thread_config_reports() const {
+    lock_guard<mutex> lock(_party_mutex);
+    return _party.thread_config_reports();
+}
+
+bool AudioProcessor::module_stats(Module *module, TimingWindow::Summary &stats) const {
+    shared_ptr<TimingWindow> timing;
+    { lock_guard<mutex> lock(_timings_mutex);
+        auto it = _timings.find(module);
+        if (it == _timings.end()) {
+            return false;
+        }
+        timing = it->second;
+    }
+
+    stats = timing->summarize();
+    return true;
+}
 
+void AudioProcessor::set_scheduler(PoolParty::Scheduler scheduler) {
+    // The scheduler is part of each snapshot's work set, so it changes along with the snapshot, never during an
+    // update.
+    _scheduler.store(scheduler, memory_order_relaxed);
+    wake_builder();
+}
+
+
+bool AudioProcessor::process_actions() {
+    bool has_changed = false;
+    Action action;
+    while (_actions.pop(action)) {
         switch (action.type) {
             case ActionType::ADD_MODULE:
                 process_add(action.data.add_remove);
@@ -152,8 +677,16 @@ void AudioProcessor::process_actions() {
             case ActionType::ROUTE_MODULE:
                 process_route(action.data.route);
                 break;
+            case ActionType::MIX_MODULE:
+                process_mix(action.data.route);
+                break;
+            case ActionType::UNMIX_MODULE:
+                process_unmix(action.data.route);
+                break;
         }
+        has_changed = true;
     }
+    return has_changed;
 }
 
 void AudioProcessor::process_add(AudioProcessor::AddRemoveData data) {
@@ -168,6 +701,14 @@ void AudioProcessor::process_add(AudioProcessor::AddRemoveData data) {
     uint32_t index = _harnesses.size();
     _harnesses.emplace_back();
     _harnesses.back().module = module;
+    _harnesses.back().inputs.resize(module->input_count());
+
+#ifdef SOUNDSTONE_MODULE_STATS
+    _harnesses.back().timing = make_shared<TimingWindow>();
+    { lock_guard<mutex> lock(_timings_mutex);
+        _timings[module] = _harnesses.back().timing;
+    }
+#endif
 
     auto result = _modules_to_harnesses.emplace(
         piecewise_construct,
@@ -175,7 +716,7 @@ void AudioProcessor::process_add(AudioProcessor::AddRemoveData data) {
         forward_as_tuple(index)
     );
 
-    _dependency_indices_are_dirty = true;
+    _graph.add(module);
 }
 
 void AudioProcessor::process_remove(AudioProcessor::AddRemoveData data) {
@@ -190,6 +731,10 @@ void AudioProcessor::process_remove(AudioProcessor::AddRemoveData data) {
     uint32_t index = it->second;
     _modules_to_harnesses.erase(it);
 
+    { lock_guard<mutex> lock(_timings_mutex);
+        _timings.erase(module);
+    }
+
     // Update indices
     for (uint32_t i = index + 1; i < _harnesses.size(); ++i) {
         Module *target = _harnesses[i].module;
@@ -197,32 +742,108 @@ void AudioProcessor::process_remove(AudioProcessor::AddRemoveData data) {
     }
 
     _harnesses.erase(_harnesses.begin() + index);
-    _dependency_indices_are_dirty = true;
+    _graph.remove(module);
 
 
-    // Unset this module as the input of any samplers
+    // Unroute this module from the inputs of any samplers
     for (ModuleHarness &harness : _harnesses) {
-        for (Module *&input : harness.inputs) {
-            if (input == module) {
-                input = nullptr;
-            }
+        for (vector<Route> &routes : harness.inputs) {
+            auto is_from_module = [module](const Route &route) { return route.source == module; };
+            routes.erase(remove_if(routes.begin(), routes.end(), is_from_module), routes.end());
         }
     }
 }
 
-void AudioProcessor::process_route(AudioProcessor::RouteData data) {
-    assert(data.index < MAX_MODULE_INPUTS);
-
+bool AudioProcessor::can_route(const RouteData &data, ModuleHarness *&harness) {
     auto it = _modules_to_harnesses.find(data.dest);
     if (it == _modules_to_harnesses.end()) {
         // Module has not been added, cannot set input.
+        return false;
+    }
+
+    harness = &_harnesses[it->second];
+    if (data.index >= harness->inputs.size()) {
+        // The module doesn't have that many inputs.
+        return false;
+    }
+    return true;
+}
+
+bool AudioProcessor::creates_cycle(const RouteData &data) {
+    if (data.source == nullptr || !_graph.depends_on(data.source, data.dest)) {
+        return false;
+    }
+    // The destination is already routed into the source, routing the other way would create a cycle that could never
+    // be processed.
+    _cyclic_route_count.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+void AudioProcessor::remove_unused_dependency(ModuleHarness &harness, Module *source) {
+    // The source may still be routed to another input.
+    for (const vector<Route> &routes : harness.inputs) {
+        for (const Route &route : routes) {
+            if (route.source == source) {
+                return;
+            }
+        }
+    }
+    _graph.remove_dependency(harness.module, source);
+}
+
+void AudioProcessor::process_route(AudioProcessor::RouteData data) {
+    ModuleHarness *harness;
+    if (!can_route(data, harness) || creates_cycle(data)) {
         return;
     }
 
-    uint32_t harness_index = it->second;
-    ModuleHarness &harness = _harnesses[harness_index];
+    vector<Route> previous_routes;
+    previous_routes.swap(harness->inputs[data.index]);
+    if (data.source != nullptr) {
+        Route route;
+        route.source = data.source;
+        harness->inputs[data.index].push_back(route);
+        _graph.add_dependency(data.dest, data.source);
+    }
 
-    harness.inputs[data.index] = data.source;
+    for (const Route &route : previous_routes) {
+        remove_unused_dependency(*harness, route.source);
+    }
+}
+
+void AudioProcessor::process_mix(AudioProcessor::RouteData data) {
+    ModuleHarness *harness;
+    if (data.source == nullptr || !can_route(data, harness) || creates_cycle(data)) {
+        return;
+    }
 
-    _dependency_indices_are_dirty = true;
+    vector<Route> &routes = harness->inputs[data.index];
+    for (Route &route : routes) {
+        if (route.source == data.source) {
+            route.gain = data.gain;
+            return;
+        }
+    }
+
+    Route route;
+    route.source = data.source;
+    route.gain = data.gain;
+    routes.push_back(route);
+    _graph.add_dependency(data.dest, data.source);
+}
+
+void AudioProcessor::process_unmix(AudioProcessor::RouteData data) {
+    ModuleHarness *harness;
+    if (!can_route(data, harness)) {
+        return;
+    }
+
+    vector<Route> &routes = harness->inputs[data.index];
+    auto is_from_source = [&data](const Route &route) { return route.source == data.source; };
+    auto it = find_if(routes.begin(), routes.end(), is_from_source);
+    if (it == routes.end()) {
+        return;
+    }
+    routes.erase(it);
+    remove_unused_dependency(*harness, data.source);
 }
@@ -0,0 +1,126 @@
+#include <soundstone/BufferLiveness.hpp>
+#include <algorithm>
+#include <cassert>
+
+using namespace soundstone;
+using namespace std;
+
+uint32_t BufferLiveness::assign(
+    const vector<vector<uint32_t>> &dependencies, Mode mode, vector<uint32_t> &buffer_indices
+) {
+    _buffers.clear();
+    buffer_indices.assign(dependencies.size(), 0);
+    build_dependents(dependencies);
+
+    switch (mode) {
+        case Mode::SEQUENTIAL:
+            assign_sequential(buffer_indices);
+            break;
+        case Mode::CONCURRENT:
+            assign_concurrent(dependencies, buffer_indices);
+            break;
+    }
+
+    return _buffers.size();
+}
+
+void BufferLiveness::build_dependents(const vector<vector<uint32_t>> &dependencies) {
+    uint32_t node_count = dependencies.size();
+    _dependents.resize(node_count);
+    for (vector<uint32_t> &dependents : _dependents) {
+        dependents.clear();
+    }
+
+    for (uint32_t node = 0; node < node_count; ++node) {
+        for (uint32_t dependency : dependencies[node]) {
+            assert(dependency < node);
+            _dependents[dependency].push_back(node);
+        }
+    }
+}
+
+void BufferLiveness::assign_sequential(vector<uint32_t> &buffer_indices) {
+    uint32_t node_count = _dependents.size();
+
+    // The buffers to free after each node has run. A node with no readers frees its own buffer right away.
+    vector<vector<uint32_t>> freed_after(node_count);
+    for (uint32_t node = 0; node < node_count; ++node) {
+        uint32_t last_reader = node;
+        for (uint32_t dependent : _dependents[node]) {
+            last_reader = max(last_reader, dependent);
+        }
+        freed_after[last_reader].push_back(node);
+    }
+
+    // Free buffers are reused most recently freed first, as those are the most likely to still be in cache.
+    vector<uint32_t> free_buffers;
+    for (uint32_t node = 0; node < node_count; ++node) {
+        if (free_buffers.empty()) {
+            buffer_indices[node] = _buffers.size();
+            _buffers.emplace_back();
+        } else {
+            buffer_indices[node] = free_buffers.back();
+            free_buffers.pop_back();
+        }
+
+        for (uint32_t freed_node : freed_after[node]) {
+            free_buffers.push_back(buffer_indices[freed_node]);
+        }
+    }
+}
+
+void BufferLiveness::assign_concurrent(
+    const vector<vector<uint32_t>> &dependencies, vector<uint32_t> &buffer_indices
+) {
+    uint32_t node_count = dependencies.size();
+
+    // Dependencies always come first, so each node's ancestors are known by the time it is reached.
+    _ancestor_words = (node_count + 63) / 64;
+    _ancestors.assign(static_cast<size_t>(node_count) * _ancestor_words, 0);
+    for (uint32_t node = 0; node < node_count; ++node) {
+        uint64_t *ancestors = &_ancestors[static_cast<size_t>(node) * _ancestor_words];
+        for (uint32_t dependency : dependencies[node]) {
+            const uint64_t *dependency_ancestors = &_ancestors[static_cast<size_t>(dependency) * _ancestor_words];
+            for (uint32_t word = 0; word < _ancestor_words; ++word) {
+                ancestors[word] |= dependency_ancestors[word];
+            }
+            ancestors[dependency / 64] |= uint64_t(1) << (dependency % 64);
+        }
+    }
+
+    for (uint32_t node = 0; node < node_count; ++node) {
+        // Look for a buffer whose readers are all guaranteed to have run before this node starts. Newer buffers
+        // are tried first, as their previous contents are the most likely to still be in cache.
+        uint32_t buffer_count = _buffers.size();
+        uint32_t chosen = buffer_count;
+        for (uint32_t i = buffer_count; i > 0 && chosen == buffer_count; --i) {
+            bool is_free = true;
+            for (uint32_t reader : _buffers[i - 1].readers) {
+                if (!is_ancestor(node, reader)) {
+                    is_free = false;
+                    break;
+                }
+            }
+            if (is_free) {
+                chosen = i - 1;
+            }
+        }
+
+        if (chosen == buffer_count) {
+            _buffers.emplace_back();
+        }
+        buffer_indices[node] = chosen;
+
+        vector<uint32_t> &readers = _buffers[chosen].readers;
+        readers = _dependents[node];
+        if (readers.empty()) {
+            // Nothing reads the output, but it is still written while the node runs.
+            readers.push_back(node);
+        }
+    }
+}
+
+bool BufferLiveness::is_ancestor(uint32_t node, uint32_t ancestor) const {
+    uint64_t word = _ancestors[static_cast<size_t>(node) * _ancestor_words + ancestor / 64];
+    return (word >> (ancestor % 64)) & 1;
+}
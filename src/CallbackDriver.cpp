@@ -0,0 +1,54 @@
+#include <soundstone/CallbackDriver.hpp>
+#include <algorithm>
+#include <cassert>
+
+using namespace soundstone;
+using namespace std;
+
+CallbackDriver::CallbackDriver(AudioProcessor *processor, SystemAudio *system, SystemOutputModule *output)
+    : _processor(processor)
+    , _system(system)
+    , _output(output)
+{
+}
+
+CallbackDriver::~CallbackDriver() {
+    finish();
+}
+
+void CallbackDriver::set_thread_config(const ThreadConfig &config) {
+    _thread_config = config;
+}
+
+void CallbackDriver::start() {
+    assert(_processor->thread_count() == 1);
+    _is_running = true;
+    _system->set_renderer(this);
+}
+
+void CallbackDriver::finish() {
+    if (!_is_running) {
+        return;
+    }
+
+    _is_running = false;
+    _system->set_renderer(nullptr);
+}
+
+void CallbackDriver::render(float *frames, uint32_t frame_count) {
+    // Processing on more than one thread can block the device's thread.
+    assert(_processor->thread_count() == 1);
+    _thread_config.apply_flush_denormals();
+
+    _output->start_rendering(frames, frame_count);
+    _processor->update(frame_count);
+    uint32_t rendered_frame_count = _output->finish_rendering();
+
+    // The output module might not be in the graph yet.
+    uint32_t channel_count = _system->channel_count();
+    fill(
+        frames + static_cast<size_t>(rendered_frame_count) * channel_count,
+        frames + static_cast<size_t>(frame_count) * channel_count,
+        0.0f
+    );
+}
@@ -0,0 +1,36 @@
+#include <soundstone/CriticalPath.hpp>
+#include <algorithm>
+#include <cassert>
+
+using namespace soundstone;
+using namespace std;
+
+void CriticalPath::measure(
+    const vector<vector<uint32_t>> &dependencies, const vector<uint64_t> &costs, vector<uint64_t> &lengths
+) {
+    uint32_t node_count = dependencies.size();
+    assert(costs.size() == node_count);
+
+    uint64_t total_cost = 0;
+    uint32_t measured_count = 0;
+    for (uint64_t cost : costs) {
+        total_cost += cost;
+        measured_count += cost > 0;
+    }
+    uint64_t unmeasured_cost = measured_count > 0 ? max<uint64_t>(total_cost / measured_count, 1) : 1;
+
+    lengths.resize(node_count);
+    for (uint32_t node = 0; node < node_count; ++node) {
+        lengths[node] = costs[node] > 0 ? costs[node] : unmeasured_cost;
+    }
+
+    // Going backwards finds the length from every dependent of a node before the node itself. Until then, a node's
+    // length is just its own cost.
+    for (uint32_t node = node_count; node-- > 0;) {
+        for (uint32_t dependency : dependencies[node]) {
+            assert(dependency < node);
+            uint64_t cost = costs[dependency] > 0 ? costs[dependency] : unmeasured_cost;
+            lengths[dependency] = max(lengths[dependency], cost + lengths[node]);
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#include "CubebBackend.hpp"
+
+using namespace soundstone;
+using namespace std;
+
+CubebBackend::~CubebBackend() {
+    close();
+}
+
+bool CubebBackend::open(uint32_t channel_count, Callbacks *callbacks) {
+    close();
+    _callbacks = callbacks;
+
+    int rv;
+
+    rv = cubeb_init(&_cubeb, nullptr, nullptr);
+    if (rv != CUBEB_OK) {
+        close();
+        return false;
+    }
+
+    rv = cubeb_get_preferred_sample_rate(_cubeb, &_sample_rate);
+    if (rv != CUBEB_OK) {
+        close();
+        return false;
+    }
+
+    cubeb_stream_params output_params;
+    output_params.format = CUBEB_SAMPLE_FLOAT32NE;
+    output_params.channels = channel_count;
+    output_params.rate = _sample_rate;
+    output_params.layout = CUBEB_LAYOUT_UNDEFINED;
+
+    rv = cubeb_get_min_latency(_cubeb, &output_params, &_latency);
+    if (rv != CUBEB_OK) {
+        close();
+        return false;
+    }
+
+    rv = cubeb_stream_init(_cubeb, &_stream, "Soundstone Application",
+                           nullptr, nullptr,
+                           nullptr, &output_params,
+                           _latency, data_callback, state_callback, this
+    );
+    if (rv != CUBEB_OK) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void CubebBackend::close() {
+    if (_stream != nullptr) {
+        cubeb_stream_destroy(_stream);
+        _stream = nullptr;
+    }
+    if (_cubeb != nullptr) {
+        cubeb_destroy(_cubeb);
+        _cubeb = nullptr;
+    }
+}
+
+bool CubebBackend::start() {
+    if (_stream == nullptr) {
+        return false;
+    }
+
+    return cubeb_stream_start(_stream) == CUBEB_OK;
+}
+
+uint32_t CubebBackend::sample_rate() const {
+    return _sample_rate;
+}
+
+uint32_t CubebBackend::latency() const {
+    return _latency;
+}
+
+long CubebBackend::data_callback(
+    cubeb_stream *stream, void *user_ptr, const void *input_buffer,
+    void *output_buffer, long nframes
+) {
+    CubebBackend *backend = reinterpret_cast<CubebBackend *>(user_ptr);
+    return backend->_callbacks->data(reinterpret_cast<float *>(output_buffer), nframes);
+}
+
+void CubebBackend::state_callback(
+    cubeb_stream *stream, void *user_ptr, cubeb_state state
+) {
+    CubebBackend *backend = reinterpret_cast<CubebBackend *>(user_ptr);
+
+    switch (state) {
+    case CUBEB_STATE_STARTED:
+        backend->_callbacks->state_changed(State::STARTED);
+        break;
+    case CUBEB_STATE_STOPPED:
+        backend->_callbacks->state_changed(State::STOPPED);
+        break;
+    case CUBEB_STATE_DRAINED:
+        backend->_callbacks->state_changed(State::DRAINED);
+        break;
+    case CUBEB_STATE_ERROR:
+        backend->_callbacks->state_changed(State::ERROR);
+        break;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <soundstone/SystemAudioBackend.hpp>
+
+#include <cubeb/cubeb.h>
+
+namespace soundstone {
+    /**
+     * Plays through the system's default output device with cubeb.
+     */
+    class CubebBackend final : public SystemAudioBackend {
+        ::cubeb *_cubeb = nullptr;
+        cubeb_stream *_stream = nullptr;
+        Callbacks *_callbacks = nullptr;
+        uint32_t _sample_rate = 0;
+        uint32_t _latency = 0;
+
+        static long data_callback(
+            cubeb_stream *stream, void *user_ptr, void const *input_buffer,
+            void *output_buffer, long nframes
+        );
+
+        static void state_callback(
+            cubeb_stream *stream, void *user_ptr, cubeb_state state
+        );
+
+    public:
+        ~CubebBackend() override;
+
+        bool open(uint32_t channel_count, Callbacks *callbacks) override;
+        void close() override;
+        bool start() override;
+        uint32_t sample_rate() const override;
+        uint32_t latency() const override;
+    };
+}
@@ -79,19 +79,94 @@ void DependencyGraph<T>::clear() {
     _nodes.clear();
 }
 
+template <typename T>
+bool DependencyGraph<T>::depends_on(T dependee, T dependency) const {
+    unordered_set<T> visited;
+    stack<T> to_visit;
+    to_visit.push(dependee);
+
+    while (!to_visit.empty()) {
+        T data = to_visit.top();
+        to_visit.pop();
+
+        if (data == dependency) {
+            return true;
+        }
+
+        auto it = _nodes.find(data);
+        if (it == _nodes.end() || !visited.insert(data).second) {
+            // Not in the graph, or already looked at.
+            continue;
+        }
+
+        for (const T &next : it->second.dependencies) {
+            to_visit.push(next);
+        }
+    }
+
+    return false;
+}
+
 template <typename T>
 unique_ptr<T[]> DependencyGraph<T>::resolve(uint32_t &count) const {
+    enum class VisitState {
+        VISITING,
+        RESOLVED
+    };
 
-    // TODO: Actually resolve correctly
+    class Visit {
+    public:
+        const GraphNode<T> *node;
+        typename unordered_set<T>::const_iterator next_dependency;
+    };
 
     unique_ptr<T[]> resolved_nodes(new T[_nodes.size()]);
+    uint32_t resolved_count = 0;
 
-    uint32_t i = 0;
-    for (const pair<T, GraphNode<T>> &item_and_node : _nodes) {
-        resolved_nodes[i++] = item_and_node.first;
+    unordered_map<T, VisitState> states;
+    states.reserve(_nodes.size());
+    stack<Visit> visits;
+
+    for (const pair<const T, GraphNode<T>> &item_and_node : _nodes) {
+        if (states.find(item_and_node.first) != states.end()) {
+            continue;
+        }
+
+        // Depth first from this node. A node is resolved once all of its dependencies are.
+        states.emplace(item_and_node.first, VisitState::VISITING);
+        visits.push({ &item_and_node.second, item_and_node.second.dependencies.begin() });
+
+        while (!visits.empty()) {
+            Visit &visit = visits.top();
+
+            if (visit.next_dependency == visit.node->dependencies.end()) {
+                states[visit.node->data] = VisitState::RESOLVED;
+                resolved_nodes[resolved_count++] = visit.node->data;
+                visits.pop();
+                continue;
+            }
+
+            T dependency = *visit.next_dependency++;
+
+            auto node_it = _nodes.find(dependency);
+            if (node_it == _nodes.end()) {
+                // Dependency isn't in the graph, nothing to wait for.
+                continue;
+            }
+
+            auto state_it = states.find(dependency);
+            if (state_it == states.end()) {
+                states.emplace(dependency, VisitState::VISITING);
+                visits.push({ &node_it->second, node_it->second.dependencies.begin() });
+            } else if (state_it->second == VisitState::VISITING) {
+                // Found our way back to a node we're still resolving.
+                count = 0;
+                return nullptr;
+            }
+        }
     }
 
-    count = _nodes.size();
+    count = resolved_count;
     return resolved_nodes;
 }
 
@@ -99,4 +174,6 @@ unique_ptr<T[]> DependencyGraph<T>::resolve(uint32_t &count) const {
 namespace soundstone {
     template class GraphNode<uint32_t>;
     template class DependencyGraph<uint32_t>;
+    template class GraphNode<Module *>;
+    template class DependencyGraph<Module *>;
 }
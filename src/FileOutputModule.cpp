@@ -0,0 +1,24 @@
+#include <soundstone/FileOutputModule.hpp>
+
+using namespace soundstone;
+using namespace std;
+
+FileOutputModule::FileOutputModule(AudioFileWriter *writer) {
+    _writer = writer;
+    _channel_count = writer->channel_count() > 0 ? writer->channel_count() : 1;
+}
+
+uint32_t FileOutputModule::channel_count() const {
+    return _channel_count;
+}
+
+void FileOutputModule::commit() {
+}
+
+void FileOutputModule::sample(const float *const *input_buffers, float *output_buffer, uint32_t nsamples) {
+    if (_writer->channel_count() != _channel_count) {
+        return;
+    }
+
+    _writer->write_planar(input_buffers[0], nsamples, nsamples);
+}
@@ -0,0 +1,32 @@
+#include <soundstone/Module.hpp>
+
+using namespace soundstone;
+
+const size_t Module::BUFFER_ALIGNMENT;
+const uint32_t Module::BUFFER_PADDING;
+
+uint32_t Module::input_count() const {
+    return 1;
+}
+
+uint32_t Module::channel_count() const {
+    return 1;
+}
+
+uint32_t Module::input_channel_count(uint32_t index) const {
+    return channel_count();
+}
+
+bool Module::preserves_silence() const {
+    return false;
+}
+
+bool Module::sample_with_silence(
+    const float * const *input_buffers,
+    const bool *silent_inputs,
+    float *output_buffer,
+    uint32_t nsamples
+) {
+    sample(input_buffers, output_buffer, nsamples);
+    return false;
+}
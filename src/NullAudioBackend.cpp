@@ -0,0 +1,170 @@
+#include <soundstone/NullAudioBackend.hpp>
+#include <algorithm>
+#include <functional>
+
+using namespace soundstone;
+using namespace std;
+using namespace std::chrono;
+
+NullAudioBackend::NullAudioBackend(uint32_t sample_rate, uint32_t period_frames, Clock clock)
+    : _sample_rate(sample_rate)
+    , _period_frames(max<uint32_t>(period_frames, 1))
+    , _clock(clock)
+{
+}
+
+NullAudioBackend::~NullAudioBackend() {
+    close();
+}
+
+bool NullAudioBackend::open(uint32_t channel_count, Callbacks *callbacks) {
+    close();
+    if (channel_count == 0 || _sample_rate == 0) {
+        return false;
+    }
+
+    _channel_count = channel_count;
+    _callbacks = callbacks;
+    _period = unique_ptr<float[]>(new float[static_cast<size_t>(_period_frames) * channel_count]);
+
+    { lock_guard<mutex> lock(_mutex);
+        _is_open = true;
+        _is_started = false;
+    }
+
+    if (_clock == Clock::REALTIME) {
+        _thread = thread(bind(&NullAudioBackend::worker, this));
+    }
+    return true;
+}
+
+void NullAudioBackend::close() {
+    { lock_guard<mutex> lock(_mutex);
+        _is_open = false;
+        _is_started = false;
+        _condition.notify_all();
+    }
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+bool NullAudioBackend::start() {
+    { lock_guard<mutex> lock(_mutex);
+        if (!_is_open) {
+            return false;
+        }
+        if (_is_started) {
+            return true;
+        }
+    }
+
+    // Reported before any period can be pulled, so it can't land after the stream has drained again.
+    _callbacks->state_changed(State::STARTED);
+
+    { lock_guard<mutex> lock(_mutex);
+        if (!_is_open) {
+            return false;
+        }
+        _is_started = true;
+        _condition.notify_all();
+    }
+    return true;
+}
+
+uint32_t NullAudioBackend::sample_rate() const {
+    return _sample_rate;
+}
+
+uint32_t NullAudioBackend::latency() const {
+    return _period_frames;
+}
+
+void NullAudioBackend::advance(uint32_t period_count) {
+    if (_clock != Clock::MANUAL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < period_count; ++i) {
+        pull_period();
+    }
+}
+
+void NullAudioBackend::worker() {
+    nanoseconds period_duration = duration_cast<nanoseconds>(duration<double>(
+        static_cast<double>(_period_frames) / _sample_rate
+    ));
+
+    unique_lock<mutex> lock(_mutex);
+    while (_is_open) {
+        if (!_is_started) {
+            _condition.wait(lock, [this] { return !_is_open || _is_started; });
+            continue;
+        }
+
+        // Periods are timed from when the stream started rather than from each other, so the clock doesn't drift.
+        auto start_time = steady_clock::now();
+        for (uint64_t period = 1; _is_open && _is_started; ++period) {
+            lock.unlock();
+            pull_period();
+            lock.lock();
+
+            _condition.wait_until(lock, start_time + period_duration * period, [this] { return !_is_open; });
+        }
+    }
+}
+
+void NullAudioBackend::pull_period() {
+    { lock_guard<mutex> lock(_mutex);
+        if (!_is_open || !_is_started) {
+            return;
+        }
+    }
+
+    long frame_count = _callbacks->data(_period.get(), static_cast<long>(_period_frames));
+    frame_count = max(0L, min(frame_count, static_cast<long>(_period_frames)));
+    bool has_underflowed = frame_count < static_cast<long>(_period_frames);
+    fill(
+        _period.get() + static_cast<size_t>(frame_count) * _channel_count,
+        _period.get() + static_cast<size_t>(_period_frames) * _channel_count,
+        0.0f
+    );
+
+    { lock_guard<mutex> lock(_mutex);
+        _frames_played += static_cast<uint64_t>(frame_count);
+        if (_is_loopback_enabled) {
+            _loopback.insert(_loopback.end(), _period.get(), _period.get() + _period_frames * _channel_count);
+        }
+        if (has_underflowed) {
+            ++_underflow_count;
+            _is_started = false;
+        }
+    }
+
+    if (has_underflowed) {
+        _callbacks->state_changed(State::DRAINED);
+    }
+}
+
+uint64_t NullAudioBackend::frames_played() const {
+    lock_guard<mutex> lock(_mutex);
+    return _frames_played;
+}
+
+uint64_t NullAudioBackend::underflow_count() const {
+    lock_guard<mutex> lock(_mutex);
+    return _underflow_count;
+}
+
+void NullAudioBackend::set_loopback_enabled(bool is_enabled) {
+    lock_guard<mutex> lock(_mutex);
+    _is_loopback_enabled = is_enabled;
+}
+
+vector<float> NullAudioBackend::take_loopback() {
+    lock_guard<mutex> lock(_mutex);
+    vector<float> loopback;
+    loopback.swap(_loopback);
+    return loopback;
+}
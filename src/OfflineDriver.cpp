@@ -0,0 +1,57 @@
+#include <soundstone/OfflineDriver.hpp>
+#include <algorithm>
+#include <limits>
+
+using namespace soundstone;
+using namespace std;
+using namespace std::chrono;
+
+const uint32_t OfflineDriver::UPDATE_FRAMES;
+
+double OfflineDriver::Report::realtime_factor() const {
+    double elapsed_seconds = duration_cast<duration<double>>(elapsed).count();
+    if (sample_rate == 0) {
+        return 0.0;
+    }
+    if (elapsed_seconds <= 0.0) {
+        return numeric_limits<double>::infinity();
+    }
+
+    return static_cast<double>(frame_count) / sample_rate / elapsed_seconds;
+}
+
+OfflineDriver::OfflineDriver(AudioProcessor *processor, uint32_t sample_rate)
+    : _processor(processor)
+    , _sample_rate(sample_rate)
+{
+}
+
+OfflineDriver::Report OfflineDriver::render(uint64_t frame_count) {
+    Report report;
+    report.frame_count = frame_count;
+    report.sample_rate = _sample_rate;
+
+    // Nothing plays in the meantime, so there's no reason to render any of it with an out of date graph.
+    _processor->wait_for_changes();
+
+    auto start_time = steady_clock::now();
+    for (uint64_t offset = 0; offset < frame_count; offset += UPDATE_FRAMES) {
+        _processor->update(static_cast<uint32_t>(min<uint64_t>(UPDATE_FRAMES, frame_count - offset)));
+    }
+    report.elapsed = duration_cast<nanoseconds>(steady_clock::now() - start_time);
+
+    return report;
+}
+
+OfflineDriver::Report OfflineDriver::render_for(std::chrono::nanoseconds duration) {
+    if (duration.count() <= 0) {
+        return render(0);
+    }
+
+    // Whole seconds and the remainder are converted separately, so neither rounding nor overflow creeps in.
+    const uint64_t nanoseconds_per_second = 1000000000;
+    uint64_t count = static_cast<uint64_t>(duration.count());
+    uint64_t frame_count = count / nanoseconds_per_second * _sample_rate +
+                           count % nanoseconds_per_second * _sample_rate / nanoseconds_per_second;
+    return render(frame_count);
+}
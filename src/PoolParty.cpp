@@ -1,9 +1,34 @@
 #include <soundstone/PoolParty.hpp>
+#include <algorithm>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 
 using namespace soundstone;
 using namespace std;
+using namespace std::chrono;
 using namespace placeholders;
 
+namespace {
+    // Tell the CPU we're busy waiting, which saves power and frees up resources for a hyperthread sibling.
+    inline void cpu_relax() {
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+}
+
+const uint32_t PoolParty::MAX_PRIORITY_BANDS;
+
+PoolParty::WaitPolicy::WaitPolicy(nanoseconds spin_time, nanoseconds yield_time)
+    : spin_time(spin_time)
+    , yield_time(yield_time)
+{
+}
+
 
 PoolParty::~PoolParty() {
     shutdown();
@@ -20,150 +45,543 @@ void PoolParty::shutdown() {
     for (uint32_t i = 0; i < _worker_count; ++i) {
         _threads[i].join();
     }
+    _worker_count = 0;
 }
 
 void PoolParty::setup(uint32_t worker_count) {
+    setup(worker_count, WaitPolicy());
+}
+
+void PoolParty::setup(uint32_t worker_count, const WaitPolicy &wait_policy) {
+    setup(worker_count, wait_policy, _thread_config);
+}
+
+void PoolParty::setup(uint32_t worker_count, const WaitPolicy &wait_policy, const ThreadConfig &thread_config) {
     shutdown();
     _should_quit = false;
+    _wait_policy = wait_policy;
+    _thread_config = thread_config;
+    _thread_config_reports.assign(worker_count, ThreadConfig::Report());
+    _configured_worker_count.store(0, memory_order_relaxed);
 
     _worker_count = worker_count;
     _threads = unique_ptr<thread[]>(new thread[worker_count]);
 
     for (uint32_t i = 0; i < worker_count; ++i) {
-        _threads[i] = thread(&PoolParty::worker_routine, this);
+        _threads[i] = thread(&PoolParty::worker_routine, this, _generation.load(), i);
     }
+
+    // Settings like memory locking take a moment, and the first work shouldn't have to wait on them.
+    while (_configured_worker_count.load(memory_order_acquire) < worker_count) {
+        this_thread::yield();
+    }
+}
+
+const vector<ThreadConfig::Report> &PoolParty::thread_config_reports() const {
+    return _thread_config_reports;
+}
+
+void PoolParty::set_scheduler(Scheduler scheduler) {
+    _scheduler = scheduler;
+    _own_work._is_dirty = true;
+}
+
+uint32_t PoolParty::worker_count() const {
+    return _worker_count;
+}
+
+PoolParty::Scheduler PoolParty::scheduler() const {
+    return _scheduler;
 }
 
 void PoolParty::add_work(std::function<void()> function) {
-    add_work(move(function), nullptr, 0);
+    _own_work.add_work(move(function));
 }
 
 void PoolParty::add_work(std::function<void()> function, const uint32_t *dependencies, uint32_t dependency_count) {
+    _own_work.add_work(move(function), dependencies, dependency_count);
+}
+
+void PoolParty::add_work(
+    std::function<void()> function, const uint32_t *dependencies, uint32_t dependency_count, uint64_t priority
+) {
+    _own_work.add_work(move(function), dependencies, dependency_count, priority);
+}
+
+void PoolParty::clear_work() {
+    _own_work.clear();
+}
+
+void PoolParty::WorkSet::add_work(std::function<void()> function) {
+    add_work(move(function), nullptr, 0);
+}
+
+void PoolParty::WorkSet::add_work(
+    std::function<void()> function, const uint32_t *dependencies, uint32_t dependency_count
+) {
+    add_work(move(function), dependencies, dependency_count, 0);
+}
+
+void PoolParty::WorkSet::add_work(
+    std::function<void()> function, const uint32_t *dependencies, uint32_t dependency_count, uint64_t priority
+) {
     WorkInfo info;
-    info.id = _work.size();
     info.func = move(function);
     info.dependencies = dependencies;
     info.dependency_count = dependency_count;
+    info.priority = priority;
     _work.emplace_back(move(info));
+    _is_dirty = true;
 }
 
-void PoolParty::work() {
-    // Note: If the rules are followed (work is not called while in progress), then all of the threads are waiting at
-    // the start condition.
+void PoolParty::WorkSet::clear() {
+    _work.clear();
+    _is_dirty = true;
+}
 
-    // Initialize completion statuses (all to false)
-    _completion_status = unique_ptr<bool[]>(new bool[_work.size()]());
+bool PoolParty::WorkSet::is_prepared_for(uint32_t worker_count) const {
+    if (_is_dirty) {
+        return false;
+    }
+    // Deques are per worker.
+    return _prepared_scheduler != Scheduler::WORK_STEALING || _prepared_worker_count == worker_count;
+}
 
-    // Keep the finish mutex locked from this point forward while starting worker threads until we are able to
-    // wait on them.
-    unique_lock<mutex> finish_lock(_finished_mutex);
+void PoolParty::WorkSet::prepare(uint32_t worker_count, Scheduler scheduler) {
+    uint32_t work_count = _work.size();
+
+    // Count the dependents of each piece of work to find where its list starts.
+    _dependent_offsets.assign(work_count + 1, 0);
+    _dependency_counts.resize(work_count);
+    for (uint32_t i = 0; i < work_count; ++i) {
+        const WorkInfo &info = _work[i];
+        _dependency_counts[i] = info.dependency_count;
+        for (uint32_t j = 0; j < info.dependency_count; ++j) {
+            ++_dependent_offsets[info.dependencies[j] + 1];
+        }
+    }
+    for (uint32_t i = 0; i < work_count; ++i) {
+        _dependent_offsets[i + 1] += _dependent_offsets[i];
+    }
 
-    // Signal all workers to start
-    { lock_guard<mutex> lock(_start_mutex);
-        _is_working = true;
-        _start_condition.notify_all();
+    // Fill in the lists.
+    vector<uint32_t> fill_offsets(_dependent_offsets.begin(), _dependent_offsets.end() - 1);
+    _dependents.resize(_dependent_offsets[work_count]);
+    for (uint32_t i = 0; i < work_count; ++i) {
+        const WorkInfo &info = _work[i];
+        for (uint32_t j = 0; j < info.dependency_count; ++j) {
+            _dependents[fill_offsets[info.dependencies[j]]++] = i;
+        }
     }
 
-    // Wait for all workers to finish
-    for (uint32_t i = 0; i < _worker_count; ++i) {
-        while (!_work.empty()) {
-            _finished_condition.wait(finish_lock);
+    // Order each list so the highest priority dependent is picked up first when several become ready at once. Bands
+    // of the shared ready list are taken from the front, while a work stealing worker takes the last thing it pushed.
+    auto is_higher_priority = [this](uint32_t a, uint32_t b) {
+        return _work[a].priority > _work[b].priority;
+    };
+    auto is_lower_priority = [this](uint32_t a, uint32_t b) {
+        return _work[a].priority < _work[b].priority;
+    };
+    for (uint32_t i = 0; i < work_count; ++i) {
+        auto begin = _dependents.begin() + _dependent_offsets[i];
+        auto end = _dependents.begin() + _dependent_offsets[i + 1];
+        if (scheduler == Scheduler::WORK_STEALING) {
+            stable_sort(begin, end, is_lower_priority);
+        } else {
+            stable_sort(begin, end, is_higher_priority);
         }
     }
 
-    _work.clear();
+    // Group work into bands of priority, each covering about as many of the distinct priorities as any other.
+    vector<uint64_t> priorities(work_count);
+    for (uint32_t i = 0; i < work_count; ++i) {
+        priorities[i] = _work[i].priority;
+    }
+    sort(priorities.begin(), priorities.end());
+    priorities.erase(unique(priorities.begin(), priorities.end()), priorities.end());
+    uint32_t band_count = min<uint32_t>(priorities.size(), MAX_PRIORITY_BANDS);
+    _work_bands.resize(work_count);
+    _band_offsets.assign(band_count + 1, 0);
+    for (uint32_t i = 0; i < work_count; ++i) {
+        uint64_t rank = lower_bound(priorities.begin(), priorities.end(), _work[i].priority) - priorities.begin();
+        _work_bands[i] = rank * band_count / priorities.size();
+        ++_band_offsets[_work_bands[i] + 1];
+    }
+    for (uint32_t i = 0; i < band_count; ++i) {
+        _band_offsets[i + 1] += _band_offsets[i];
+    }
+
+    if (_work_count != work_count || _unfinished_dependency_counts == nullptr) {
+        _work_count = work_count;
+        _unfinished_dependency_counts = unique_ptr<atomic<uint32_t>[]>(new atomic<uint32_t>[work_count]);
+        _ready = unique_ptr<atomic<uint32_t>[]>(new atomic<uint32_t>[work_count]);
+    }
+    if (_band_count != band_count || _band_push_counts == nullptr) {
+        _band_count = band_count;
+        _band_push_counts = unique_ptr<atomic<uint32_t>[]>(new atomic<uint32_t>[band_count]);
+        _band_pop_counts = unique_ptr<atomic<uint32_t>[]>(new atomic<uint32_t>[band_count]);
+    }
+
+    _initial_work.clear();
+    for (uint32_t i = 0; i < work_count; ++i) {
+        if (_dependency_counts[i] == 0) {
+            _initial_work.push_back(i);
+        }
+    }
+    // Initial work is always taken from the front.
+    stable_sort(_initial_work.begin(), _initial_work.end(), is_higher_priority);
+
+    if (scheduler == Scheduler::WORK_STEALING) {
+        // Any single worker could end up making every piece of work ready. The last deque is for the thread calling
+        // work.
+        _deques = unique_ptr<WorkStealingDeque[]>(new WorkStealingDeque[worker_count + 1]);
+        for (uint32_t i = 0; i <= worker_count; ++i) {
+            _deques[i].reserve(work_count);
+        }
+    } else {
+        _deques.reset();
+    }
+
+    _prepared_worker_count = worker_count;
+    _prepared_scheduler = scheduler;
+    _is_dirty = false;
 }
 
-void PoolParty::worker_routine() {
-    WorkInfo work = {};
+void PoolParty::reset_work_state(WorkSet &set) {
+    for (uint32_t i = 0; i < set._work_count; ++i) {
+        set._unfinished_dependency_counts[i].store(set._dependency_counts[i], memory_order_relaxed);
+    }
+    _remaining_work.store(set._work_count, memory_order_relaxed);
 
-    while (true) {
+    if (set._prepared_scheduler == Scheduler::WORK_STEALING) {
+        for (uint32_t i = 0; i <= _worker_count; ++i) {
+            set._deques[i].reset();
+        }
+        _initial_work_index.store(0, memory_order_relaxed);
+    } else {
+        for (uint32_t i = 0; i < set._work_count; ++i) {
+            set._ready[i].store(NO_WORK, memory_order_relaxed);
+        }
+        for (uint32_t i = 0; i < set._band_count; ++i) {
+            set._band_push_counts[i].store(0, memory_order_relaxed);
+            set._band_pop_counts[i].store(0, memory_order_relaxed);
+        }
 
-        // Check if the workers should rise up and go on strike.
-        { unique_lock<mutex> lock(_start_mutex);
-            while (!(_should_quit || _is_working)) {
-                _start_condition.wait(lock);
-            }
+        // Work with no dependencies is ready right away.
+        for (uint32_t id : set._initial_work) {
+            push_ready(set, id);
+        }
+    }
+}
 
-            if (_should_quit) {
-                break;
+void PoolParty::work() {
+    work(_own_work);
+}
+
+void PoolParty::work(WorkSet &set) {
+    // Note: If the rules are followed (work is not called while in progress), then all of the work from the last call
+    // has been completed.
+
+    uint64_t generation;
+    Scheduler scheduler;
+
+    { lock_guard<mutex> lock(_start_mutex);
+        // A prepared set keeps the scheduler it was prepared with, and is only prepared again for a different
+        // number of workers.
+        bool needs_prepare = !set.is_prepared_for(_worker_count);
+        scheduler = set._is_dirty ? _scheduler : set._prepared_scheduler;
+
+        // Workers may still be on their way out of the last call. Work stealing workers look at shared state until
+        // they leave, so wait for them before anything is reset. Holding the start mutex keeps late workers from
+        // joining the last call in the meantime.
+        if (scheduler == Scheduler::WORK_STEALING || needs_prepare || &set != _current_work) {
+            while (_active_workers.load(memory_order_acquire) > 0) {
+                this_thread::yield();
             }
         }
+        _current_work = &set;
 
-        // We've got work to do.
-        bool has_work = true;
-
-        while (true) {
-
-            // Figure out what to do next
-            bool found_work = false;
-
-            while (true) {
-                unique_lock<mutex> lock(_work_mutex);
-
-                if (_work.empty()) {
-                    // No more work to do.
-                    has_work = false;
-                    break;
-                }
-
-                // Figure out what to work on next.
-                // Reverse iterate through to work list so that it is efficient to delete items, given that the work is
-                // given to the pool party in reverse dependency order.
-                for (size_t i = _work.size(); i > 0; --i) {
-                    WorkInfo &info = _work[i - 1];
-                    found_work = true;
-
-                    for (uint32_t j = 0; j < info.dependency_count; ++j) {
-                        uint32_t dependency_index = info.dependencies[j];
-                        if (!_completion_status[dependency_index]) {
-                            found_work = false;
-                            break;
-                        }
-                    }
-
-                    if (found_work) {
-                        work = info;
-                        _work.erase(_work.begin() + i - 1);
-                        break;
-                    }
-                }
-
-                if (!found_work) {
-                    // No work that we're allowed to work on. Wait until some work gets done and try again.
-                    _update_condition.wait(lock);
-                } else {
-                    // Work was found, so let's break outta here and do the work!
-                    break;
-                }
-            }
+        if (needs_prepare) {
+            set.prepare(_worker_count, scheduler);
+        }
+
+        if (set._work_count == 0) {
+            return;
+        }
+
+        reset_work_state(set);
+
+        // Signal all workers to start
+        generation = _generation.load(memory_order_relaxed) + 1;
+        _ready_claim_position.store(generation << 32, memory_order_relaxed);
+        _generation.store(generation, memory_order_release);
+        _start_condition.notify_all();
+    }
+
+    // Help out instead of just waiting for the workers.
+    if (scheduler == Scheduler::WORK_STEALING) {
+        run_work_stealing(set, _worker_count);
+    } else {
+        run_shared(set, generation);
+    }
 
-            if (!has_work) {
-                // There's no work to do, so let's get outta here.
+    // Wait for all work to be completed.
+    auto is_finished = [this]{ return _remaining_work.load(memory_order_acquire) == 0; };
+    if (spin_then_yield(is_finished)) {
+        return;
+    }
+
+    // The last worker to finish takes the finish mutex before notifying, so holding it between checking and waiting
+    // is enough to not miss the notification. It must not be held any earlier, as a worker from the last call may
+    // still be on its way to take it.
+    unique_lock<mutex> finish_lock(_finished_mutex);
+    while (!is_finished()) {
+        _finished_condition.wait(finish_lock);
+    }
+}
+
+void PoolParty::push_ready(WorkSet &set, uint32_t id) {
+    uint32_t band = set._work_bands[id];
+    uint32_t slot = set._band_offsets[band] + set._band_push_counts[band].fetch_add(1, memory_order_relaxed);
+    set._ready[slot].store(id, memory_order_release);
+}
+
+uint32_t PoolParty::pop_ready(WorkSet &set) {
+    for (uint32_t band = set._band_count; band-- > 0;) {
+        atomic<uint32_t> &pop_count = set._band_pop_counts[band];
+        const atomic<uint32_t> *slots = set._ready.get() + set._band_offsets[band];
+        uint32_t slot_count = set._band_offsets[band + 1] - set._band_offsets[band];
+
+        // Slots are handed out in order but may be filled out of order. An empty slot at the front means nothing in
+        // the band is ready yet, or that it's about to be, so move on rather than wait for it.
+        uint32_t index = pop_count.load(memory_order_relaxed);
+        while (index < slot_count) {
+            uint32_t id = slots[index].load(memory_order_acquire);
+            if (id == NO_WORK) {
                 break;
             }
+            if (pop_count.compare_exchange_weak(index, index + 1, memory_order_relaxed)) {
+                return id;
+            }
+        }
+    }
+    return NO_WORK;
+}
 
-            work.func();
+bool PoolParty::claim_ready_work(uint64_t generation, uint32_t work_count) {
+    uint64_t position = _ready_claim_position.load(memory_order_acquire);
+    while (true) {
+        if ((position >> 32) != (generation & UINT32_MAX) || static_cast<uint32_t>(position) >= work_count) {
+            // Everything has been claimed, or this is a call we don't know about yet.
+            return false;
+        }
+        if (_ready_claim_position.compare_exchange_weak(position, position + 1, memory_order_acquire)) {
+            return true;
+        }
+    }
+}
+
+uint32_t PoolParty::wait_for_ready(WorkSet &set) {
+    // There are as many claims as pieces of work, so some work will be made ready for this claim.
+    uint32_t id;
+    wait_until([&]{
+        id = pop_ready(set);
+        return id != NO_WORK;
+    });
+    return id;
+}
+
+uint32_t PoolParty::take_initial_work(WorkSet &set) {
+    uint32_t index = _initial_work_index.load(memory_order_relaxed);
+    while (index < set._initial_work.size()) {
+        if (_initial_work_index.compare_exchange_weak(index, index + 1, memory_order_relaxed)) {
+            return set._initial_work[index];
+        }
+    }
+    return WorkStealingDeque::EMPTY;
+}
 
-            // Notify the other friends which may be waiting due to work dependencies.
-            { lock_guard<mutex> lock(_work_mutex);
-                // While we have the work mutex locked, we also need to set the completion status of this work.
-                _completion_status[work.id] = true;
+uint32_t PoolParty::steal_work(WorkSet &set, uint32_t worker_index) {
+    uint32_t deque_count = _worker_count + 1;
+    for (uint32_t i = 1; i < deque_count; ++i) {
+        uint32_t id = set._deques[(worker_index + i) % deque_count].steal();
+        if (id != WorkStealingDeque::EMPTY) {
+            return id;
+        }
+    }
+    return WorkStealingDeque::EMPTY;
+}
 
-                _update_condition.notify_all();
+void PoolParty::finish_work(WorkSet &set, uint32_t id, WorkStealingDeque *deque) {
+    // Any dependents that were only waiting on this work are now ready.
+    bool made_ready = false;
+    for (uint32_t i = set._dependent_offsets[id], ilen = set._dependent_offsets[id + 1]; i < ilen; ++i) {
+        uint32_t dependent = set._dependents[i];
+        if (set._unfinished_dependency_counts[dependent].fetch_sub(1, memory_order_acq_rel) == 1) {
+            if (deque != nullptr) {
+                deque->push(dependent);
+            } else {
+                push_ready(set, dependent);
             }
+            made_ready = true;
         }
+    }
+
+    bool is_finished = _remaining_work.fetch_sub(1, memory_order_acq_rel) == 1;
 
+    if (made_ready || is_finished) {
+        // Sleeping work stealing workers also need to wake up to leave once everything is done.
+        wake_idle();
+    }
+
+    if (is_finished) {
         // Tell the work invoking thread that the work is done
-        { lock_guard<mutex> lock(_finished_mutex);
-            _is_working = false;
-            _finished_condition.notify_all();
+        lock_guard<mutex> lock(_finished_mutex);
+        _finished_condition.notify_all();
+    }
+}
+
+void PoolParty::run_shared(WorkSet &set, uint64_t generation) {
+    // Claim ready work until every piece of work has been claimed.
+    while (claim_ready_work(generation, set._work_count)) {
+        uint32_t id = wait_for_ready(set);
+        set._work[id].func();
+        finish_work(set, id, nullptr);
+    }
+}
+
+void PoolParty::run_work_stealing(WorkSet &set, uint32_t worker_index) {
+    WorkStealingDeque &deque = set._deques[worker_index];
 
+    uint32_t id;
+    auto find_work = [&]{
+        // Prefer the work this worker made ready most recently, as its inputs are likely still in cache.
+        id = deque.take();
+        if (id == WorkStealingDeque::EMPTY) {
+            id = take_initial_work(set);
         }
+        if (id == WorkStealingDeque::EMPTY) {
+            id = steal_work(set, worker_index);
+        }
+        return id != WorkStealingDeque::EMPTY || _remaining_work.load(memory_order_acquire) == 0;
+    };
+
+    while (true) {
+        wait_until(find_work);
+        if (id == WorkStealingDeque::EMPTY) {
+            // Everything is done.
+            break;
+        }
+
+        set._work[id].func();
+        finish_work(set, id, &deque);
+    }
+}
+
+template <typename Predicate>
+bool PoolParty::spin_then_yield(Predicate predicate) const {
+    if (predicate()) {
+        return true;
+    }
+
+    auto start_time = steady_clock::now();
+    auto spin_end_time = start_time + _wait_policy.spin_time;
+    auto yield_end_time = spin_end_time + _wait_policy.yield_time;
+
+    while (true) {
+        // Reading the clock isn't free, so only do it every so often.
+        for (uint32_t i = 0; i < 64; ++i) {
+            if (predicate()) {
+                return true;
+            }
+            cpu_relax();
+        }
+
+        auto now = steady_clock::now();
+        if (now >= yield_end_time) {
+            return false;
+        }
+        if (now >= spin_end_time) {
+            this_thread::yield();
+        }
+    }
+}
+
+template <typename Predicate>
+void PoolParty::wait_until(Predicate predicate) {
+    if (spin_then_yield(predicate)) {
+        return;
+    }
+
+    // Nothing came up for a while, so sleep until some work is made ready. The epoch is read before checking so that
+    // work made ready after the check is noticed. Registering as idle before re-reading the epoch (both sequentially
+    // consistent) means wake_idle either sees this thread as idle or this thread sees the new epoch.
+    while (true) {
+        uint32_t epoch = _idle_epoch.load(memory_order_seq_cst);
+        if (predicate()) {
+            return;
+        }
+
+        unique_lock<mutex> lock(_idle_mutex);
+        _idle_thread_count.fetch_add(1, memory_order_seq_cst);
+        while (_idle_epoch.load(memory_order_seq_cst) == epoch) {
+            _idle_condition.wait(lock);
+        }
+        _idle_thread_count.fetch_sub(1, memory_order_relaxed);
+    }
+}
+
+void PoolParty::wake_idle() {
+    _idle_epoch.fetch_add(1, memory_order_seq_cst);
+    if (_idle_thread_count.load(memory_order_seq_cst) > 0) {
+        lock_guard<mutex> lock(_idle_mutex);
+        _idle_condition.notify_all();
+    }
+}
+
+void PoolParty::worker_routine(uint64_t generation, uint32_t worker_index) {
+    WorkSet *set = nullptr;
+    Scheduler scheduler = Scheduler::SHARED;
+
+    _thread_config_reports[worker_index] = _thread_config.apply();
+    _configured_worker_count.fetch_add(1, memory_order_release);
+
+    auto should_wake = [&]{
+        return _should_quit.load(memory_order_acquire) || _generation.load(memory_order_acquire) != generation;
+    };
+
+    while (true) {
+
+        // Check if the workers should rise up and go on strike. Work coming in soon after the last call is picked up
+        // without needing to be woken up.
+        spin_then_yield(should_wake);
+
+        { unique_lock<mutex> lock(_start_mutex);
+            while (!should_wake()) {
+                _start_condition.wait(lock);
+            }
+
+            if (_should_quit) {
+                break;
+            }
+
+            // The set was prepared before the call started, so its scheduler can't change until the next one.
+            generation = _generation;
+            set = _current_work;
+            scheduler = set->_prepared_scheduler;
+            _active_workers.fetch_add(1, memory_order_relaxed);
+        }
+
+        if (scheduler == Scheduler::WORK_STEALING) {
+            run_work_stealing(*set, worker_index);
+        } else {
+            run_shared(*set, generation);
+        }
+
+        _active_workers.fetch_sub(1, memory_order_release);
 
         // Back to top
     }
 
     // Worker has quit.
 }
-
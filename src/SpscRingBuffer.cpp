@@ -0,0 +1,83 @@
+#include <soundstone/SpscRingBuffer.hpp>
+#include <algorithm>
+
+using namespace soundstone;
+using namespace std;
+
+template <typename T>
+SpscRingBuffer<T>::SpscRingBuffer() = default;
+
+template <typename T>
+SpscRingBuffer<T>::SpscRingBuffer(size_t capacity) {
+    reserve(capacity);
+}
+
+template <typename T>
+SpscRingBuffer<T>::~SpscRingBuffer() {
+    delete [] _buffer;
+}
+
+template <typename T>
+void SpscRingBuffer<T>::reserve(size_t capacity) {
+    size_t rounded_capacity = 1;
+    while (rounded_capacity < capacity) {
+        rounded_capacity <<= 1;
+    }
+
+    delete [] _buffer;
+    _buffer = new T[rounded_capacity];
+    _capacity = rounded_capacity;
+    _mask = rounded_capacity - 1;
+    _read_index.store(0, memory_order_relaxed);
+    _write_index.store(0, memory_order_relaxed);
+}
+
+template <typename T>
+size_t SpscRingBuffer<T>::capacity() const {
+    return _capacity;
+}
+
+template <typename T>
+size_t SpscRingBuffer<T>::size() const {
+    size_t read_index = _read_index.load(memory_order_acquire);
+    size_t write_index = _write_index.load(memory_order_acquire);
+    return write_index - read_index;
+}
+
+template <typename T>
+size_t SpscRingBuffer<T>::produce(const T *data, size_t count) {
+    size_t write_index = _write_index.load(memory_order_relaxed);
+    // Acquire the consumer's index so it has finished reading any slots we're about to overwrite.
+    size_t read_index = _read_index.load(memory_order_acquire);
+
+    count = min(count, _capacity - (write_index - read_index));
+    size_t start = write_index & _mask;
+    size_t first_count = min(count, _capacity - start);
+    copy_n(data, first_count, _buffer + start);
+    copy_n(data + first_count, count - first_count, _buffer);
+
+    // Release the new items to the consumer.
+    _write_index.store(write_index + count, memory_order_release);
+    return count;
+}
+
+template <typename T>
+size_t SpscRingBuffer<T>::consume(T *data, size_t count) {
+    size_t read_index = _read_index.load(memory_order_relaxed);
+    // Acquire the producer's index so the items it wrote are visible.
+    size_t write_index = _write_index.load(memory_order_acquire);
+
+    count = min(count, write_index - read_index);
+    size_t start = read_index & _mask;
+    size_t first_count = min(count, _capacity - start);
+    copy_n(_buffer + start, first_count, data);
+    copy_n(_buffer, count - first_count, data + first_count);
+
+    // Release the slots back to the producer.
+    _read_index.store(read_index + count, memory_order_release);
+    return count;
+}
+
+namespace soundstone {
+    template class SpscRingBuffer<float>;
+}
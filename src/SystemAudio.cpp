@@ -1,124 +1,182 @@
 #include <soundstone/SystemAudio.hpp>
 
-#include <cubeb/cubeb.h>
+#include "CubebBackend.hpp"
+
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <limits>
+#include <thread>
 
 using namespace soundstone;
 using namespace std;
+using namespace std::chrono;
+
+const size_t SystemAudio::BUFFER_CAPACITY;
+const uint32_t SystemAudio::Telemetry::DEPTH_BUCKET_COUNT;
 
 namespace soundstone {
-    class SystemAudio::Internal {
+    class SystemAudio::Internal : public SystemAudioBackend::Callbacks {
     public:
-        cubeb *cubeb = nullptr;
-        cubeb_stream *stream = nullptr;
-        cubeb_state state = {};
+        SystemAudio *system = nullptr;
+        unique_ptr<SystemAudioBackend> backend;
+        bool is_open = false;
+        SystemAudioBackend::State state = SystemAudioBackend::State::ERROR;
+
+        // Telemetry, only written by the device callback and read with relaxed loads by telemetry.
+        atomic<uint64_t> callback_count {0};
+        atomic<uint64_t> underflow_count {0};
+        atomic<uint64_t> short_fill_frames {0};
+        atomic<uint32_t> min_buffered_frames {numeric_limits<uint32_t>::max()};
+        atomic<uint32_t> max_buffered_frames {0};
+        array<atomic<uint64_t>, Telemetry::DEPTH_BUCKET_COUNT> buffered_frames_histogram;
+        TimingWindow callback_duration;
+        TimingWindow period_jitter;
+
+        // Only touched by the device callback.
+        bool has_previous_callback = false;
+        steady_clock::time_point previous_callback_time;
+        long previous_frame_count = 0;
+
+        Internal();
+
+        long data(float *frames, long frame_count) override;
+        void state_changed(SystemAudioBackend::State state) override;
+
+        void record_buffered_frames(size_t frame_count);
+        void record_callback(steady_clock::time_point start_time, long frame_count, long frames_written);
+
+        // Counters only ever have one writer, so they don't need a read-modify-write.
+        template <typename T>
+        static void increment(atomic<T> &counter, T amount = 1) {
+            counter.store(counter.load(memory_order_relaxed) + amount, memory_order_relaxed);
+        }
+    };
 
-        static long data_callback(
-            cubeb_stream *stream, void *user_ptr, void const *input_buffer,
-            void *output_buffer, long nframes
-        );
+}
 
-        static void state_callback(
-            cubeb_stream *stream, void *user_ptr, cubeb_state state
-        );
-    };
 
+SystemAudio::Internal::Internal() {
+    for (atomic<uint64_t> &bucket : buffered_frames_histogram) {
+        bucket.store(0, memory_order_relaxed);
+    }
 }
 
+SystemAudio::SystemAudio(uint32_t channel_count)
+    : SystemAudio(unique_ptr<SystemAudioBackend>(new CubebBackend()), channel_count)
+{
+}
 
-SystemAudio::SystemAudio()
+SystemAudio::SystemAudio(unique_ptr<SystemAudioBackend> backend, uint32_t channel_count)
     : _internal(new Internal())
+    , _channel_count(channel_count)
+    , _data(BUFFER_CAPACITY * channel_count)
 {
-    cubeb_init(&_internal->cubeb, nullptr, nullptr);
-    _internal->state = CUBEB_STATE_ERROR;
-    if (!init_cubeb()) {
-        destroy_cubeb();
+    assert(channel_count > 0);
+    _internal->system = this;
+    _internal->backend = move(backend);
+    if (!_internal->backend->open(channel_count, _internal.get())) {
+        return;
+    }
+
+    _sample_rate = _internal->backend->sample_rate();
+    _latency = _internal->backend->latency();
+    _internal->is_open = _internal->backend->start();
+    if (!_internal->is_open) {
+        _internal->backend->close();
     }
 }
 
 SystemAudio::~SystemAudio() {
-    destroy_cubeb();
+    _internal->backend->close();
 }
 
-bool SystemAudio::init_cubeb() {
-    int rv;
-
-    rv = cubeb_get_preferred_sample_rate(_internal->cubeb, &_sample_rate);
-    if (rv != CUBEB_OK) {
-        return false;
+long SystemAudio::Internal::data(float *frames, long frame_count) {
+    steady_clock::time_point start_time = steady_clock::now();
+    system->_active_callback_count.fetch_add(1, memory_order_seq_cst);
+    long frames_written = frame_count;
+    Renderer *renderer = system->_renderer.load(memory_order_seq_cst);
+    if (renderer != nullptr) {
+        renderer->render(frames, static_cast<uint32_t>(frame_count));
+    } else {
+        // Only whole frames are ever produced, so only whole frames are consumed.
+        size_t previous_frame_count = system->_data.size() / system->_channel_count;
+        record_buffered_frames(previous_frame_count);
+        size_t actual_samples = system->_data.consume(
+            frames,
+            static_cast<size_t>(frame_count) * system->_channel_count
+        );
+        size_t buffered_frame_count = system->_data.size() / system->_channel_count;
+        frames_written = static_cast<long>(actual_samples / system->_channel_count);
+
+        // Only crossing the mark is reported, so a listener that keeps the queue below it is not woken repeatedly.
+        LowWaterListener *listener = system->_low_water_listener.load(memory_order_seq_cst);
+        uint32_t low_water_frames = system->_low_water_frames.load(memory_order_relaxed);
+        if (
+            listener != nullptr && previous_frame_count > low_water_frames &&
+            buffered_frame_count <= low_water_frames
+        ) {
+            listener->on_low_water();
+        }
     }
+    system->_active_callback_count.fetch_sub(1, memory_order_release);
 
-    cubeb_stream_params output_params;
-    output_params.format = CUBEB_SAMPLE_FLOAT32NE;
-    output_params.channels = 1;
-    output_params.rate = _sample_rate;
-    output_params.layout = CUBEB_LAYOUT_UNDEFINED;
+    record_callback(start_time, frame_count, frames_written);
+    return frames_written;
+}
 
-    rv = cubeb_get_min_latency(_internal->cubeb, &output_params, &_latency);
-    if (rv != CUBEB_OK) {
-        return false;
+void SystemAudio::Internal::record_buffered_frames(size_t frame_count) {
+    uint32_t depth = static_cast<uint32_t>(min<size_t>(frame_count, numeric_limits<uint32_t>::max()));
+    if (depth < min_buffered_frames.load(memory_order_relaxed)) {
+        min_buffered_frames.store(depth, memory_order_relaxed);
     }
-
-    rv = cubeb_stream_init(_internal->cubeb, &_internal->stream, "Soundstone Application",
-                           nullptr, nullptr,
-                           nullptr, &output_params,
-                           _latency, Internal::data_callback, Internal::state_callback, this
-    );
-    if (rv != CUBEB_OK) {
-        return false;
+    if (depth > max_buffered_frames.load(memory_order_relaxed)) {
+        max_buffered_frames.store(depth, memory_order_relaxed);
     }
 
-    rv = cubeb_stream_start(_internal->stream);
-    return rv == CUBEB_OK;
-}
-
-void SystemAudio::destroy_cubeb() {
-    if (_internal->stream != nullptr) {
-        cubeb_stream_destroy(_internal->stream);
-        _internal->stream = nullptr;
-    }
-    if (_internal->cubeb != nullptr) {
-        cubeb_destroy(_internal->cubeb);
-        _internal->cubeb = nullptr;
+    uint32_t bucket = 0;
+    while (depth > 0 && bucket + 1 < Telemetry::DEPTH_BUCKET_COUNT) {
+        depth >>= 1;
+        ++bucket;
     }
+    increment(buffered_frames_histogram[bucket]);
 }
 
-long SystemAudio::Internal::data_callback(
-    cubeb_stream *stream, void *user_ptr, const void *input_buffer,
-    void *output_buffer, long nframes
+void SystemAudio::Internal::record_callback(
+    steady_clock::time_point start_time, long frame_count, long frames_written
 ) {
-    SystemAudio *system = reinterpret_cast<SystemAudio *>(user_ptr);
-    size_t actual_frames;
-    {
-        lock_guard<mutex> lock(system->_data_mutex);
-        actual_frames = min(static_cast<size_t>(nframes), system->_data.size());
-        system->_data.consume(
-            reinterpret_cast<float *>(output_buffer),
-            actual_frames
-        );
+    increment(callback_count);
+    if (frames_written < frame_count) {
+        increment(underflow_count);
+        increment(short_fill_frames, static_cast<uint64_t>(frame_count - frames_written));
     }
-    return static_cast<long>(actual_frames);
-}
 
-void SystemAudio::Internal::state_callback(
-    cubeb_stream *stream, void *user_ptr, cubeb_state state
-) {
-    SystemAudio *system = reinterpret_cast<SystemAudio *>(user_ptr);
+    // The previous callback's frames should run out just as this one starts.
+    uint32_t sample_rate = system->_sample_rate;
+    if (has_previous_callback && sample_rate > 0) {
+        nanoseconds interval = duration_cast<nanoseconds>(start_time - previous_callback_time);
+        nanoseconds expected_interval(static_cast<int64_t>(previous_frame_count) * 1000000000 / sample_rate);
+        period_jitter.record(interval > expected_interval ? interval - expected_interval
+                                                          : expected_interval - interval);
+    }
+    has_previous_callback = frames_written == frame_count;
+    previous_callback_time = start_time;
+    previous_frame_count = frame_count;
+
+    callback_duration.record(duration_cast<nanoseconds>(steady_clock::now() - start_time));
+}
 
+void SystemAudio::Internal::state_changed(SystemAudioBackend::State state) {
     unique_lock<mutex> state_lock(system->_stream_state_mutex);
-    system->_internal->state = state;
+    this->state = state;
     state_lock.unlock();
 
-    if (state == CUBEB_STATE_DRAINED) {
-        uint32_t buffered_samples;
-        { lock_guard<mutex> data_lock(system->_data_mutex);
-            buffered_samples = system->_data.size();
-        }
+    if (state == SystemAudioBackend::State::DRAINED) {
+        uint32_t buffered_samples = system->samples_buffered();
 
         if (buffered_samples > 0) {
             // We've got some data queued up at this point, so lets restart the stream now.
-            cubeb_stream_start(stream);
+            backend->start();
         }
 
         { lock_guard<mutex> lock(system->_drained_callback_mutex);
@@ -131,24 +189,27 @@ void SystemAudio::Internal::state_callback(
 
 
 bool SystemAudio::is_ok() const {
-    return _internal->cubeb != nullptr && _internal->stream != nullptr;
+    return _internal->is_open;
 }
 
 bool SystemAudio::is_steam_ok() const {
-    return _internal->state != CUBEB_STATE_ERROR;
+    return _internal->state != SystemAudioBackend::State::ERROR;
 }
 
 bool SystemAudio::is_stream_playing() const {
-    return _internal->state == CUBEB_STATE_STARTED;
+    return _internal->state == SystemAudioBackend::State::STARTED;
 }
 
 bool SystemAudio::is_stream_drained() const {
-    return _internal->state == CUBEB_STATE_DRAINED;
+    return _internal->state == SystemAudioBackend::State::DRAINED;
 }
 
 uint32_t SystemAudio::samples_buffered() const {
-    lock_guard<mutex> lock(_data_mutex);
-    return _data.size();
+    return _data.size() / _channel_count;
+}
+
+uint32_t SystemAudio::channel_count() const {
+    return _channel_count;
 }
 
 uint32_t SystemAudio::sample_rate() const {
@@ -159,24 +220,73 @@ uint32_t SystemAudio::latency() const {
     return _latency;
 }
 
-void SystemAudio::update(const float *data, size_t sample_count) {
-    { lock_guard<mutex> lock(_data_mutex);
-        _data.produce(data, sample_count);
-    }
+size_t SystemAudio::update(const float *data, size_t frame_count) {
+    // Only queue whole frames, so the callback never sees half of one.
+    size_t free_frames = (_data.capacity() - _data.size()) / _channel_count;
+    size_t queued_count = _data.produce(data, min(frame_count, free_frames) * _channel_count) / _channel_count;
 
     // Restart the stream if we previously ran out of data
-    if (is_ok()) {
-        bool should_restart_stream;
-        { lock_guard<mutex> lock(_stream_state_mutex);
-            should_restart_stream = _internal->state == CUBEB_STATE_DRAINED;
-        }
-        if (should_restart_stream) {
-            cubeb_stream_start(_internal->stream);
-        }
-    }
+    restart_drained_stream();
+
+    return queued_count;
 }
 
 void SystemAudio::set_drained_callback(std::function<void()> callback) {
     lock_guard<mutex> lock(_drained_callback_mutex);
     _drained_callback = move(callback);
 }
+
+SystemAudio::Telemetry SystemAudio::telemetry() const {
+    Telemetry telemetry;
+    telemetry.callback_count = _internal->callback_count.load(memory_order_relaxed);
+    telemetry.underflow_count = _internal->underflow_count.load(memory_order_relaxed);
+    telemetry.short_fill_frames = _internal->short_fill_frames.load(memory_order_relaxed);
+
+    uint32_t min_buffered_frames = _internal->min_buffered_frames.load(memory_order_relaxed);
+    telemetry.min_buffered_frames = min_buffered_frames == numeric_limits<uint32_t>::max() ? 0 : min_buffered_frames;
+    telemetry.max_buffered_frames = _internal->max_buffered_frames.load(memory_order_relaxed);
+    for (uint32_t i = 0; i < Telemetry::DEPTH_BUCKET_COUNT; ++i) {
+        telemetry.buffered_frames_histogram[i] = _internal->buffered_frames_histogram[i].load(memory_order_relaxed);
+    }
+
+    telemetry.callback_duration = _internal->callback_duration.summarize();
+    telemetry.period_jitter = _internal->period_jitter.summarize();
+    return telemetry;
+}
+
+void SystemAudio::set_renderer(Renderer *renderer) {
+    _renderer.store(renderer, memory_order_seq_cst);
+    wait_for_callbacks();
+
+    // The stream drains when it runs out of queued frames, and a renderer never runs out.
+    if (renderer != nullptr) {
+        restart_drained_stream();
+    }
+}
+
+void SystemAudio::set_low_water_listener(LowWaterListener *listener, uint32_t low_water_frames) {
+    _low_water_frames.store(low_water_frames, memory_order_relaxed);
+    _low_water_listener.store(listener, memory_order_seq_cst);
+    wait_for_callbacks();
+}
+
+void SystemAudio::wait_for_callbacks() {
+    // A callback which counted itself in before the last store may still be using what was replaced.
+    while (_active_callback_count.load(memory_order_acquire) != 0) {
+        this_thread::yield();
+    }
+}
+
+void SystemAudio::restart_drained_stream() {
+    if (!is_ok()) {
+        return;
+    }
+
+    bool should_restart_stream;
+    { lock_guard<mutex> lock(_stream_state_mutex);
+        should_restart_stream = _internal->state == SystemAudioBackend::State::DRAINED;
+    }
+    if (should_restart_stream) {
+        _internal->backend->start();
+    }
+}
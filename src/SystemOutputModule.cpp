@@ -1,14 +1,53 @@
 #include <soundstone/SystemOutputModule.hpp>
+#include <soundstone/simd/Kernels.hpp>
+#include <algorithm>
 
 using namespace soundstone;
+using namespace std;
+
+const uint32_t SystemOutputModule::INTERLEAVE_FRAMES;
 
 SystemOutputModule::SystemOutputModule(soundstone::SystemAudio *audio) {
     _audio = audio;
+    _channel_count = audio->channel_count();
+    _interleaved = unique_ptr<float[]>(new float[INTERLEAVE_FRAMES * _channel_count]);
+}
+
+uint32_t SystemOutputModule::channel_count() const {
+    return _channel_count;
 }
 
 void SystemOutputModule::commit() {
 }
 
 void SystemOutputModule::sample(const float *const *input_buffers, float *output_buffer, uint32_t nsamples) {
-    _audio->update(input_buffers[0], nsamples);
+    if (_render_frames != nullptr) {
+        uint32_t frame_count = min(nsamples, _render_frame_count - _rendered_frame_count);
+        float *frames = _render_frames + static_cast<size_t>(_rendered_frame_count) * _channel_count;
+        simd::interleave(input_buffers[0], nsamples, _channel_count, frame_count, frames);
+        _rendered_frame_count += frame_count;
+        return;
+    }
+
+    if (_channel_count == 1) {
+        _audio->update(input_buffers[0], nsamples);
+        return;
+    }
+
+    for (uint32_t offset = 0; offset < nsamples; offset += INTERLEAVE_FRAMES) {
+        uint32_t frame_count = min(INTERLEAVE_FRAMES, nsamples - offset);
+        simd::interleave(input_buffers[0] + offset, nsamples, _channel_count, frame_count, _interleaved.get());
+        _audio->update(_interleaved.get(), frame_count);
+    }
+}
+
+void SystemOutputModule::start_rendering(float *frames, uint32_t frame_count) {
+    _render_frames = frames;
+    _render_frame_count = frame_count;
+    _rendered_frame_count = 0;
+}
+
+uint32_t SystemOutputModule::finish_rendering() {
+    _render_frames = nullptr;
+    return _rendered_frame_count;
 }
@@ -0,0 +1,106 @@
+#include <soundstone/ThreadConfig.hpp>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SOUNDSTONE_POSIX_THREADS
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <alloca.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SOUNDSTONE_MXCSR
+#include <xmmintrin.h>
+#endif
+
+using namespace soundstone;
+using namespace std;
+
+namespace {
+    // Flush to zero and denormals are zero.
+    const unsigned int MXCSR_FTZ = 0x8000;
+    const unsigned int MXCSR_DAZ = 0x0040;
+    const uint64_t FPCR_FZ = 1 << 24;
+
+    // Pages are at least this big everywhere we run.
+    const size_t PAGE_SIZE_BYTES = 4096;
+
+    bool apply_priority(ThreadConfig::Policy policy, int priority) {
+#if defined(SOUNDSTONE_POSIX_THREADS)
+        int native_policy = policy == ThreadConfig::Policy::FIFO ? SCHED_FIFO : SCHED_RR;
+        sched_param param;
+        param.sched_priority = min(
+            max(priority, sched_get_priority_min(native_policy)),
+            sched_get_priority_max(native_policy)
+        );
+        return pthread_setschedparam(pthread_self(), native_policy, &param) == 0;
+#else
+        return false;
+#endif
+    }
+
+    bool apply_affinity(const vector<uint32_t> &cpus) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (uint32_t cpu : cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    bool lock_all_memory() {
+#if defined(SOUNDSTONE_POSIX_THREADS)
+        return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#else
+        return false;
+#endif
+    }
+
+    bool prefault_stack(size_t byte_count) {
+#if defined(SOUNDSTONE_POSIX_THREADS)
+        // Writes through a volatile pointer, so the compiler can't decide the memory is never used.
+        volatile char *stack = static_cast<volatile char *>(alloca(byte_count));
+        for (size_t i = 0; i < byte_count; i += PAGE_SIZE_BYTES) {
+            stack[i] = 0;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool flush_denormals() {
+#if defined(SOUNDSTONE_MXCSR)
+        _mm_setcsr(_mm_getcsr() | MXCSR_FTZ | MXCSR_DAZ);
+        return (_mm_getcsr() & (MXCSR_FTZ | MXCSR_DAZ)) == (MXCSR_FTZ | MXCSR_DAZ);
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+        uint64_t fpcr;
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | FPCR_FZ));
+        return true;
+#else
+        return false;
+#endif
+    }
+}
+
+ThreadConfig::Report ThreadConfig::apply() const {
+    Report report;
+    report.priority = policy != Policy::DEFAULT && apply_priority(policy, priority);
+    report.affinity = !cpus.empty() && apply_affinity(cpus);
+    report.memory_locked = lock_memory && lock_all_memory();
+    report.stack_prefaulted = prefault_stack_bytes > 0 && prefault_stack(prefault_stack_bytes);
+    report.denormals_flushed = apply_flush_denormals();
+    return report;
+}
+
+bool ThreadConfig::apply_flush_denormals() const {
+    return flush_denormals && ::flush_denormals();
+}
@@ -1,11 +1,11 @@
 #include <soundstone/ThreadedDriver.hpp>
-#include <iostream>
+#include <algorithm>
 
 using namespace soundstone;
 using namespace std;
 using namespace std::chrono;
 
-ThreadedDriver::ThreadedDriver(AudioProcessor *processor, const SystemAudio *system)
+ThreadedDriver::ThreadedDriver(AudioProcessor *processor, SystemAudio *system)
     : _processor(processor)
     , _system(system)
 {
@@ -20,14 +20,33 @@ void ThreadedDriver::set_update_interval(std::chrono::nanoseconds ns) {
 }
 
 void ThreadedDriver::set_latency_samples(uint32_t latency_samples) {
-    _latency_samples = latency_samples;
+    _high_water_samples = latency_samples;
+}
+
+void ThreadedDriver::set_low_water_samples(uint32_t low_water_samples) {
+    _low_water_samples = low_water_samples;
+}
+
+void ThreadedDriver::set_thread_config(const ThreadConfig &config) {
+    _thread_config = config;
+}
+
+ThreadConfig::Report ThreadedDriver::thread_config_report() {
+    lock_guard<mutex> lock(_is_running_mutex);
+    return _thread_config_report;
 }
 
 void ThreadedDriver::start() {
     finish();
 
     _is_running = true;
+    _is_configured = false;
+    _is_woken.store(false, memory_order_relaxed);
+    _system->set_low_water_listener(this, _low_water_samples);
     _thread = thread(bind(&ThreadedDriver::worker, this));
+
+    unique_lock<mutex> lock(_is_running_mutex);
+    _is_running_condition.wait(lock, [this] { return _is_configured; });
 }
 
 void ThreadedDriver::finish() {
@@ -41,30 +60,45 @@ void ThreadedDriver::finish() {
     }
 
     _thread.join();
+    _system->set_low_water_listener(nullptr, 0);
 }
 
+void ThreadedDriver::on_low_water() {
+    _is_woken.store(true, memory_order_release);
+    _is_running_condition.notify_one();
+}
 
 void ThreadedDriver::worker() {
     uint32_t sample_rate = _system->sample_rate();
+    ThreadConfig::Report report = _thread_config.apply();
 
-    double floating_interval_seconds = duration_cast<duration<double>>(_update_interval).count();
-    uint32_t samples_per_frame = static_cast<uint32_t>(sample_rate * floating_interval_seconds);
+    unique_lock<mutex> lock(_is_running_mutex);
+    _thread_config_report = report;
+    _is_configured = true;
+    _is_running_condition.notify_all();
 
-    while (worker_should_run()) {
-        auto start_time = steady_clock::now();
+    while (_is_running) {
+        lock.unlock();
 
-        uint32_t needed_samples = samples_per_frame + _latency_samples;
         uint32_t buffered_samples = _system->samples_buffered();
-
-        if (needed_samples > buffered_samples) {
-            _processor->update(needed_samples - buffered_samples);
+        if (_high_water_samples > buffered_samples) {
+            _processor->update(_high_water_samples - buffered_samples);
         }
+        nanoseconds timeout = time_until_low_water(_system->samples_buffered(), sample_rate);
 
-        this_thread::sleep_until(start_time + _update_interval);
+        lock.lock();
+        _is_running_condition.wait_for(lock, timeout, [this] {
+            return !_is_running || _is_woken.exchange(false, memory_order_acquire);
+        });
     }
 }
 
-bool ThreadedDriver::worker_should_run() {
-    unique_lock<mutex> lock(_is_running_mutex);
-    return _is_running;
+nanoseconds ThreadedDriver::time_until_low_water(uint32_t buffered_samples, uint32_t sample_rate) const {
+    // Already at the mark after rendering means the queue could not take more, and only time will change that.
+    if (buffered_samples <= _low_water_samples || sample_rate == 0) {
+        return _update_interval;
+    }
+
+    duration<double> seconds(static_cast<double>(buffered_samples - _low_water_samples) / sample_rate);
+    return min(duration_cast<nanoseconds>(seconds), _update_interval);
 }
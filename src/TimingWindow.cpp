@@ -0,0 +1,76 @@
+#include <soundstone/TimingWindow.hpp>
+#include <algorithm>
+#include <limits>
+
+using namespace soundstone;
+using namespace std;
+using namespace std::chrono;
+
+const uint32_t TimingWindow::CAPACITY;
+
+TimingWindow::TimingWindow() {
+    for (atomic<uint32_t> &duration : _durations) {
+        duration.store(0, memory_order_relaxed);
+    }
+}
+
+void TimingWindow::record(std::chrono::nanoseconds duration) {
+    int64_t count = max<int64_t>(duration.count(), 0);
+    uint32_t clamped_count = static_cast<uint32_t>(min<int64_t>(count, numeric_limits<uint32_t>::max()));
+
+    uint32_t sequence = _sequence.load(memory_order_relaxed);
+    _sequence.store(sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    uint64_t record_count = _count.load(memory_order_relaxed);
+    _durations[record_count % CAPACITY].store(clamped_count, memory_order_relaxed);
+    _count.store(record_count + 1, memory_order_relaxed);
+
+    _sequence.store(sequence + 2, memory_order_release);
+}
+
+TimingWindow::Summary TimingWindow::summarize() const {
+    array<uint32_t, CAPACITY> durations;
+    uint64_t count;
+
+    // Copy the window out, trying again if a record was written meanwhile.
+    while (true) {
+        uint32_t sequence = _sequence.load(memory_order_acquire);
+        if (sequence % 2 != 0) {
+            continue;
+        }
+
+        count = _count.load(memory_order_relaxed);
+        for (uint32_t i = 0; i < CAPACITY; ++i) {
+            durations[i] = _durations[i].load(memory_order_relaxed);
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        if (_sequence.load(memory_order_relaxed) == sequence) {
+            break;
+        }
+    }
+
+    Summary summary;
+    summary.count = count;
+    if (count == 0) {
+        return summary;
+    }
+
+    uint32_t window_count = static_cast<uint32_t>(min<uint64_t>(count, CAPACITY));
+    summary.last = nanoseconds(durations[(count - 1) % CAPACITY]);
+
+    // Until the window has filled, the runs in it are the ones at the start.
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < window_count; ++i) {
+        total += durations[i];
+    }
+    summary.mean = nanoseconds(total / window_count);
+    summary.max = nanoseconds(*max_element(durations.begin(), durations.begin() + window_count));
+
+    uint32_t p99_index = (window_count * 99 + 99) / 100 - 1;
+    nth_element(durations.begin(), durations.begin() + p99_index, durations.begin() + window_count);
+    summary.p99 = nanoseconds(durations[p99_index]);
+
+    return summary;
+}
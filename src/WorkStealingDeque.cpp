@@ -0,0 +1,71 @@
+#include <soundstone/WorkStealingDeque.hpp>
+#include <cassert>
+
+using namespace soundstone;
+using namespace std;
+
+// Follows "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al.), without the circular array
+// resizing.
+
+const uint32_t WorkStealingDeque::EMPTY;
+
+void WorkStealingDeque::reserve(uint32_t capacity) {
+    if (capacity > _capacity) {
+        _items = unique_ptr<atomic<uint32_t>[]>(new atomic<uint32_t>[capacity]);
+        _capacity = capacity;
+    }
+    reset();
+}
+
+void WorkStealingDeque::reset() {
+    _top.store(0, memory_order_relaxed);
+    _bottom.store(0, memory_order_relaxed);
+}
+
+void WorkStealingDeque::push(uint32_t id) {
+    int64_t bottom = _bottom.load(memory_order_relaxed);
+    assert(bottom < static_cast<int64_t>(_capacity));
+    _items[bottom].store(id, memory_order_relaxed);
+    // A release store rather than a release fence, which is as cheap and which thread sanitizer understands.
+    _bottom.store(bottom + 1, memory_order_release);
+}
+
+uint32_t WorkStealingDeque::take() {
+    int64_t bottom = _bottom.load(memory_order_relaxed) - 1;
+    _bottom.store(bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = _top.load(memory_order_relaxed);
+
+    if (top > bottom) {
+        // Empty
+        _bottom.store(bottom + 1, memory_order_relaxed);
+        return EMPTY;
+    }
+
+    uint32_t id = _items[bottom].load(memory_order_relaxed);
+    if (top == bottom) {
+        // Last item, so race against any thieves for it.
+        if (!_top.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            id = EMPTY;
+        }
+        _bottom.store(bottom + 1, memory_order_relaxed);
+    }
+    return id;
+}
+
+uint32_t WorkStealingDeque::steal() {
+    int64_t top = _top.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = _bottom.load(memory_order_acquire);
+
+    if (top >= bottom) {
+        return EMPTY;
+    }
+
+    uint32_t id = _items[top].load(memory_order_relaxed);
+    if (!_top.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        // Lost the race to another thief or the owner.
+        return EMPTY;
+    }
+    return id;
+}
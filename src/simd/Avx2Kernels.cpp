@@ -0,0 +1,206 @@
+#include "KernelTables.hpp"
+
+#if defined(SOUNDSTONE_SIMD_X86)
+#include <immintrin.h>
+
+using namespace soundstone;
+using namespace soundstone::simd;
+
+namespace {
+    SOUNDSTONE_TARGET("avx2")
+    void sum_avx2(const float * const *inputs, uint32_t input_count, float *output, uint32_t count) {
+        if (input_count == 0) {
+            SCALAR_KERNELS.sum(inputs, input_count, output, count);
+            return;
+        }
+
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256 total = _mm256_loadu_ps(inputs[0] + i);
+            for (uint32_t input = 1; input < input_count; ++input) {
+                total = _mm256_add_ps(total, _mm256_loadu_ps(inputs[input] + i));
+            }
+            _mm256_storeu_ps(output + i, total);
+        }
+        for (; i < count; ++i) {
+            float total = inputs[0][i];
+            for (uint32_t input = 1; input < input_count; ++input) {
+                total += inputs[input][i];
+            }
+            output[i] = total;
+        }
+    }
+
+    // Multiplies and adds are kept separate rather than fused, so results match the other instruction sets exactly.
+    SOUNDSTONE_TARGET("avx2")
+    void scaled_add_avx2(const float *input, float gain, float *output, uint32_t count) {
+        __m256 gains = _mm256_set1_ps(gain);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256 scaled = _mm256_mul_ps(_mm256_loadu_ps(input + i), gains);
+            _mm256_storeu_ps(output + i, _mm256_add_ps(_mm256_loadu_ps(output + i), scaled));
+        }
+        SCALAR_KERNELS.scaled_add(input + i, gain, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx2")
+    void gain_ramp_avx2(const float *input, float start_gain, float end_gain, float *output, uint32_t count) {
+        float step = (end_gain - start_gain) / static_cast<float>(count);
+        __m256 starts = _mm256_set1_ps(start_gain);
+        __m256 steps = _mm256_set1_ps(step);
+        __m256i offsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i index_values = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int32_t>(i)), offsets);
+            __m256 gains = _mm256_add_ps(starts, _mm256_mul_ps(steps, _mm256_cvtepi32_ps(index_values)));
+            _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_loadu_ps(input + i), gains));
+        }
+        for (; i < count; ++i) {
+            output[i] = input[i] * (start_gain + step * static_cast<float>(i));
+        }
+    }
+
+    SOUNDSTONE_TARGET("avx2")
+    __m256 clamp_vector(__m256 values, __m256 mins, __m256 maxes) {
+        return _mm256_min_ps(maxes, _mm256_max_ps(mins, values));
+    }
+
+    SOUNDSTONE_TARGET("avx2")
+    void clamp_avx2(const float *input, float min, float max, float *output, uint32_t count) {
+        __m256 mins = _mm256_set1_ps(min);
+        __m256 maxes = _mm256_set1_ps(max);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(output + i, clamp_vector(_mm256_loadu_ps(input + i), mins, maxes));
+        }
+        SCALAR_KERNELS.clamp(input + i, min, max, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx2")
+    __m256i float_to_integer_vector(const float *input, __m256 scales, __m256 mins, __m256 maxes) {
+        return _mm256_cvtps_epi32(clamp_vector(_mm256_mul_ps(_mm256_loadu_ps(input), scales), mins, maxes));
+    }
+
+    SOUNDSTONE_TARGET("avx2")
+    void float_to_int16_avx2(const float *input, int16_t *output, uint32_t count) {
+        __m256 scales = _mm256_set1_ps(INT16_SCALE);
+        __m256 mins = _mm256_set1_ps(INT16_MIN_FLOAT);
+        __m256 maxes = _mm256_set1_ps(INT16_MAX_FLOAT);
+        uint32_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256i low = float_to_integer_vector(input + i, scales, mins, maxes);
+            __m256i high = float_to_integer_vector(input + i + 8, scales, mins, maxes);
+            // Packing works within 128 bit lanes, leaving the 64 bit quarters out of order.
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i), packed);
+        }
+        SCALAR_KERNELS.float_to_int16(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx2")
+    void int16_to_float_avx2(const int16_t *input, float *output, uint32_t count) {
+        __m256 inverse_scales = _mm256_set1_ps(1.0f / INT16_SCALE);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+            __m256 floats = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(values));
+            _mm256_storeu_ps(output + i, _mm256_mul_ps(floats, inverse_scales));
+        }
+        SCALAR_KERNELS.int16_to_float(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx2")
+    void float_to_int24_avx2(const float *input, int32_t *output, uint32_t count) {
+        __m256 scales = _mm256_set1_ps(INT24_SCALE);
+        __m256 mins = _mm256_set1_ps(INT24_MIN_FLOAT);
+        __m256 maxes = _mm256_set1_ps(INT24_MAX_FLOAT);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i values = float_to_integer_vector(input + i, scales, mins, maxes);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i), values);
+        }
+        SCALAR_KERNELS.float_to_int24(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx2")
+    void int24_to_float_avx2(const int32_t *input, float *output, uint32_t count) {
+        __m256 inverse_scales = _mm256_set1_ps(1.0f / INT24_SCALE);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+            _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(values), inverse_scales));
+        }
+        SCALAR_KERNELS.int24_to_float(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx2")
+    void interleave_avx2(
+        const float *planar, uint32_t stride, uint32_t channel_count, uint32_t frame_count, float *interleaved
+    ) {
+        if (channel_count != 2) {
+            SCALAR_KERNELS.interleave(planar, stride, channel_count, frame_count, interleaved);
+            return;
+        }
+
+        const float *left = planar;
+        const float *right = planar + stride;
+        uint32_t i = 0;
+        for (; i + 8 <= frame_count; i += 8) {
+            __m256 l = _mm256_loadu_ps(left + i);
+            __m256 r = _mm256_loadu_ps(right + i);
+            // Unpacking works within 128 bit lanes, giving frames 0, 1, 4, 5 and 2, 3, 6, 7.
+            __m256 low = _mm256_unpacklo_ps(l, r);
+            __m256 high = _mm256_unpackhi_ps(l, r);
+            _mm256_storeu_ps(interleaved + i * 2, _mm256_permute2f128_ps(low, high, 0x20));
+            _mm256_storeu_ps(interleaved + i * 2 + 8, _mm256_permute2f128_ps(low, high, 0x31));
+        }
+        for (; i < frame_count; ++i) {
+            interleaved[i * 2] = left[i];
+            interleaved[i * 2 + 1] = right[i];
+        }
+    }
+
+    SOUNDSTONE_TARGET("avx2")
+    void deinterleave_avx2(
+        const float *interleaved, uint32_t channel_count, uint32_t frame_count, float *planar, uint32_t stride
+    ) {
+        if (channel_count != 2) {
+            SCALAR_KERNELS.deinterleave(interleaved, channel_count, frame_count, planar, stride);
+            return;
+        }
+
+        float *left = planar;
+        float *right = planar + stride;
+        uint32_t i = 0;
+        for (; i + 8 <= frame_count; i += 8) {
+            __m256 first = _mm256_loadu_ps(interleaved + i * 2);
+            __m256 second = _mm256_loadu_ps(interleaved + i * 2 + 8);
+            // Shuffling works within 128 bit lanes, giving frames 0, 1, 4, 5, 2, 3, 6, 7.
+            __m256 l = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 r = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+            l = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0)));
+            r = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0)));
+            _mm256_storeu_ps(left + i, l);
+            _mm256_storeu_ps(right + i, r);
+        }
+        for (; i < frame_count; ++i) {
+            left[i] = interleaved[i * 2];
+            right[i] = interleaved[i * 2 + 1];
+        }
+    }
+}
+
+const KernelTable soundstone::simd::AVX2_KERNELS = {
+    sum_avx2,
+    scaled_add_avx2,
+    gain_ramp_avx2,
+    clamp_avx2,
+    float_to_int16_avx2,
+    int16_to_float_avx2,
+    float_to_int24_avx2,
+    int24_to_float_avx2,
+    interleave_avx2,
+    deinterleave_avx2
+};
+
+#endif
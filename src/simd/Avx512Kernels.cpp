@@ -0,0 +1,199 @@
+#include "KernelTables.hpp"
+
+#if defined(SOUNDSTONE_SIMD_X86)
+#include <immintrin.h>
+
+using namespace soundstone;
+using namespace soundstone::simd;
+
+namespace {
+    SOUNDSTONE_TARGET("avx512f")
+    void sum_avx512(const float * const *inputs, uint32_t input_count, float *output, uint32_t count) {
+        if (input_count == 0) {
+            SCALAR_KERNELS.sum(inputs, input_count, output, count);
+            return;
+        }
+
+        uint32_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m512 total = _mm512_loadu_ps(inputs[0] + i);
+            for (uint32_t input = 1; input < input_count; ++input) {
+                total = _mm512_add_ps(total, _mm512_loadu_ps(inputs[input] + i));
+            }
+            _mm512_storeu_ps(output + i, total);
+        }
+        for (; i < count; ++i) {
+            float total = inputs[0][i];
+            for (uint32_t input = 1; input < input_count; ++input) {
+                total += inputs[input][i];
+            }
+            output[i] = total;
+        }
+    }
+
+    // Multiplies and adds are kept separate rather than fused, so results match the other instruction sets exactly.
+    SOUNDSTONE_TARGET("avx512f")
+    void scaled_add_avx512(const float *input, float gain, float *output, uint32_t count) {
+        __m512 gains = _mm512_set1_ps(gain);
+        uint32_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m512 scaled = _mm512_mul_ps(_mm512_loadu_ps(input + i), gains);
+            _mm512_storeu_ps(output + i, _mm512_add_ps(_mm512_loadu_ps(output + i), scaled));
+        }
+        SCALAR_KERNELS.scaled_add(input + i, gain, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx512f")
+    void gain_ramp_avx512(const float *input, float start_gain, float end_gain, float *output, uint32_t count) {
+        float step = (end_gain - start_gain) / static_cast<float>(count);
+        __m512 starts = _mm512_set1_ps(start_gain);
+        __m512 steps = _mm512_set1_ps(step);
+        __m512i offsets = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        uint32_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m512i index_values = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int32_t>(i)), offsets);
+            __m512 gains = _mm512_add_ps(starts, _mm512_mul_ps(steps, _mm512_cvtepi32_ps(index_values)));
+            _mm512_storeu_ps(output + i, _mm512_mul_ps(_mm512_loadu_ps(input + i), gains));
+        }
+        for (; i < count; ++i) {
+            output[i] = input[i] * (start_gain + step * static_cast<float>(i));
+        }
+    }
+
+    SOUNDSTONE_TARGET("avx512f")
+    __m512 clamp_vector(__m512 values, __m512 mins, __m512 maxes) {
+        return _mm512_min_ps(maxes, _mm512_max_ps(mins, values));
+    }
+
+    SOUNDSTONE_TARGET("avx512f")
+    void clamp_avx512(const float *input, float min, float max, float *output, uint32_t count) {
+        __m512 mins = _mm512_set1_ps(min);
+        __m512 maxes = _mm512_set1_ps(max);
+        uint32_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            _mm512_storeu_ps(output + i, clamp_vector(_mm512_loadu_ps(input + i), mins, maxes));
+        }
+        SCALAR_KERNELS.clamp(input + i, min, max, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx512f")
+    __m512i float_to_integer_vector(const float *input, __m512 scales, __m512 mins, __m512 maxes) {
+        return _mm512_cvtps_epi32(clamp_vector(_mm512_mul_ps(_mm512_loadu_ps(input), scales), mins, maxes));
+    }
+
+    SOUNDSTONE_TARGET("avx512f")
+    void float_to_int16_avx512(const float *input, int16_t *output, uint32_t count) {
+        __m512 scales = _mm512_set1_ps(INT16_SCALE);
+        __m512 mins = _mm512_set1_ps(INT16_MIN_FLOAT);
+        __m512 maxes = _mm512_set1_ps(INT16_MAX_FLOAT);
+        uint32_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256i values = _mm512_cvtsepi32_epi16(float_to_integer_vector(input + i, scales, mins, maxes));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i), values);
+        }
+        SCALAR_KERNELS.float_to_int16(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx512f")
+    void int16_to_float_avx512(const int16_t *input, float *output, uint32_t count) {
+        __m512 inverse_scales = _mm512_set1_ps(1.0f / INT16_SCALE);
+        uint32_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+            __m512 floats = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(values));
+            _mm512_storeu_ps(output + i, _mm512_mul_ps(floats, inverse_scales));
+        }
+        SCALAR_KERNELS.int16_to_float(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx512f")
+    void float_to_int24_avx512(const float *input, int32_t *output, uint32_t count) {
+        __m512 scales = _mm512_set1_ps(INT24_SCALE);
+        __m512 mins = _mm512_set1_ps(INT24_MIN_FLOAT);
+        __m512 maxes = _mm512_set1_ps(INT24_MAX_FLOAT);
+        uint32_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            _mm512_storeu_si512(output + i, float_to_integer_vector(input + i, scales, mins, maxes));
+        }
+        SCALAR_KERNELS.float_to_int24(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx512f")
+    void int24_to_float_avx512(const int32_t *input, float *output, uint32_t count) {
+        __m512 inverse_scales = _mm512_set1_ps(1.0f / INT24_SCALE);
+        uint32_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m512i values = _mm512_loadu_si512(input + i);
+            _mm512_storeu_ps(output + i, _mm512_mul_ps(_mm512_cvtepi32_ps(values), inverse_scales));
+        }
+        SCALAR_KERNELS.int24_to_float(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("avx512f")
+    void interleave_avx512(
+        const float *planar, uint32_t stride, uint32_t channel_count, uint32_t frame_count, float *interleaved
+    ) {
+        if (channel_count != 2) {
+            SCALAR_KERNELS.interleave(planar, stride, channel_count, frame_count, interleaved);
+            return;
+        }
+
+        // Indices into the concatenation of both channels, right samples starting at 16.
+        const __m512i low_indices = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+        const __m512i high_indices = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+        const float *left = planar;
+        const float *right = planar + stride;
+        uint32_t i = 0;
+        for (; i + 16 <= frame_count; i += 16) {
+            __m512 l = _mm512_loadu_ps(left + i);
+            __m512 r = _mm512_loadu_ps(right + i);
+            _mm512_storeu_ps(interleaved + i * 2, _mm512_permutex2var_ps(l, low_indices, r));
+            _mm512_storeu_ps(interleaved + i * 2 + 16, _mm512_permutex2var_ps(l, high_indices, r));
+        }
+        for (; i < frame_count; ++i) {
+            interleaved[i * 2] = left[i];
+            interleaved[i * 2 + 1] = right[i];
+        }
+    }
+
+    SOUNDSTONE_TARGET("avx512f")
+    void deinterleave_avx512(
+        const float *interleaved, uint32_t channel_count, uint32_t frame_count, float *planar, uint32_t stride
+    ) {
+        if (channel_count != 2) {
+            SCALAR_KERNELS.deinterleave(interleaved, channel_count, frame_count, planar, stride);
+            return;
+        }
+
+        const __m512i left_indices = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        const __m512i right_indices = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+        float *left = planar;
+        float *right = planar + stride;
+        uint32_t i = 0;
+        for (; i + 16 <= frame_count; i += 16) {
+            __m512 first = _mm512_loadu_ps(interleaved + i * 2);
+            __m512 second = _mm512_loadu_ps(interleaved + i * 2 + 16);
+            _mm512_storeu_ps(left + i, _mm512_permutex2var_ps(first, left_indices, second));
+            _mm512_storeu_ps(right + i, _mm512_permutex2var_ps(first, right_indices, second));
+        }
+        for (; i < frame_count; ++i) {
+            left[i] = interleaved[i * 2];
+            right[i] = interleaved[i * 2 + 1];
+        }
+    }
+}
+
+const KernelTable soundstone::simd::AVX512_KERNELS = {
+    sum_avx512,
+    scaled_add_avx512,
+    gain_ramp_avx512,
+    clamp_avx512,
+    float_to_int16_avx512,
+    int16_to_float_avx512,
+    float_to_int24_avx512,
+    int24_to_float_avx512,
+    interleave_avx512,
+    deinterleave_avx512
+};
+
+#endif
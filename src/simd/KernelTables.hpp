@@ -0,0 +1,34 @@
+#pragma once
+#include <soundstone/simd/Kernels.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SOUNDSTONE_SIMD_X86
+#endif
+
+// Kernels for instruction sets beyond the build's baseline are compiled with function level target attributes, so
+// the rest of the library never uses instructions the CPU might not have. MSVC allows intrinsics without them.
+#if defined(__GNUC__) || defined(__clang__)
+#define SOUNDSTONE_TARGET(instruction_sets) __attribute__((target(instruction_sets)))
+#else
+#define SOUNDSTONE_TARGET(instruction_sets)
+#endif
+
+namespace soundstone {
+namespace simd {
+    extern const KernelTable SCALAR_KERNELS;
+
+#if defined(SOUNDSTONE_SIMD_X86)
+    extern const KernelTable SSE2_KERNELS;
+    extern const KernelTable AVX2_KERNELS;
+    extern const KernelTable AVX512_KERNELS;
+#endif
+
+    // Limits of float to integer conversion, which are exact as floats.
+    const float INT16_SCALE = 32768.0f;
+    const float INT16_MIN_FLOAT = -32768.0f;
+    const float INT16_MAX_FLOAT = 32767.0f;
+    const float INT24_SCALE = 8388608.0f;
+    const float INT24_MIN_FLOAT = -8388608.0f;
+    const float INT24_MAX_FLOAT = 8388607.0f;
+}
+}
@@ -0,0 +1,199 @@
+#include "KernelTables.hpp"
+#include <atomic>
+
+#if defined(SOUNDSTONE_SIMD_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+using namespace soundstone;
+using namespace soundstone::simd;
+using namespace std;
+
+namespace {
+    // Chosen on first use. Detection always picks the same table, so threads racing to set it agree.
+    atomic<const KernelTable *> active_kernels {nullptr};
+
+#if defined(SOUNDSTONE_SIMD_X86)
+    class CpuidResult {
+    public:
+        uint32_t eax = 0;
+        uint32_t ebx = 0;
+        uint32_t ecx = 0;
+        uint32_t edx = 0;
+    };
+
+    CpuidResult cpuid(uint32_t leaf, uint32_t subleaf) {
+        CpuidResult result;
+#if defined(_MSC_VER)
+        int registers[4];
+        __cpuidex(registers, static_cast<int>(leaf), static_cast<int>(subleaf));
+        result.eax = registers[0];
+        result.ebx = registers[1];
+        result.ecx = registers[2];
+        result.edx = registers[3];
+#else
+        __cpuid_count(leaf, subleaf, result.eax, result.ebx, result.ecx, result.edx);
+#endif
+        return result;
+    }
+
+    // The register state the operating system saves on context switches. Only valid when OSXSAVE is set.
+    uint64_t enabled_register_state() {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        uint32_t eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+    }
+#endif
+
+    bool is_supported(InstructionSet instruction_set) {
+        return static_cast<int>(instruction_set) <= static_cast<int>(detect_instruction_set());
+    }
+
+    const KernelTable *current_kernels() {
+        const KernelTable *kernels = active_kernels.load(memory_order_acquire);
+        if (kernels == nullptr) {
+            kernels = kernel_table(detect_instruction_set());
+            active_kernels.store(kernels, memory_order_release);
+        }
+        return kernels;
+    }
+}
+
+InstructionSet simd::detect_instruction_set() {
+#if defined(SOUNDSTONE_SIMD_X86)
+    const uint32_t SSE2_BIT = 1u << 26;
+    const uint32_t OSXSAVE_BIT = 1u << 27;
+    const uint32_t AVX_BIT = 1u << 28;
+    const uint32_t AVX2_BIT = 1u << 5;
+    const uint32_t AVX512F_BIT = 1u << 16;
+    // SSE and AVX registers, then AVX-512 mask and upper registers as well.
+    const uint64_t AVX_STATE = 0x6;
+    const uint64_t AVX512_STATE = 0xe6;
+
+    uint32_t max_leaf = cpuid(0, 0).eax;
+    CpuidResult features = cpuid(1, 0);
+    if (!(features.edx & SSE2_BIT)) {
+        return InstructionSet::SCALAR;
+    }
+
+    bool has_avx_state = false;
+    bool has_avx512_state = false;
+    if ((features.ecx & OSXSAVE_BIT) && (features.ecx & AVX_BIT)) {
+        uint64_t state = enabled_register_state();
+        has_avx_state = (state & AVX_STATE) == AVX_STATE;
+        has_avx512_state = (state & AVX512_STATE) == AVX512_STATE;
+    }
+    if (max_leaf < 7 || !has_avx_state) {
+        return InstructionSet::SSE2;
+    }
+
+    CpuidResult extended_features = cpuid(7, 0);
+    if (has_avx512_state && (extended_features.ebx & AVX512F_BIT) && (extended_features.ebx & AVX2_BIT)) {
+        return InstructionSet::AVX512;
+    }
+    if (extended_features.ebx & AVX2_BIT) {
+        return InstructionSet::AVX2;
+    }
+    return InstructionSet::SSE2;
+#else
+    return InstructionSet::SCALAR;
+#endif
+}
+
+const KernelTable *simd::kernel_table(InstructionSet instruction_set) {
+    if (!is_supported(instruction_set)) {
+        return nullptr;
+    }
+
+    switch (instruction_set) {
+        case InstructionSet::SCALAR:
+            return &SCALAR_KERNELS;
+#if defined(SOUNDSTONE_SIMD_X86)
+        case InstructionSet::SSE2:
+            return &SSE2_KERNELS;
+        case InstructionSet::AVX2:
+            return &AVX2_KERNELS;
+        case InstructionSet::AVX512:
+            return &AVX512_KERNELS;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+InstructionSet simd::instruction_set() {
+    const KernelTable *kernels = current_kernels();
+#if defined(SOUNDSTONE_SIMD_X86)
+    if (kernels == &AVX512_KERNELS) {
+        return InstructionSet::AVX512;
+    }
+    if (kernels == &AVX2_KERNELS) {
+        return InstructionSet::AVX2;
+    }
+    if (kernels == &SSE2_KERNELS) {
+        return InstructionSet::SSE2;
+    }
+#endif
+    return InstructionSet::SCALAR;
+}
+
+bool simd::set_instruction_set(InstructionSet instruction_set) {
+    const KernelTable *kernels = kernel_table(instruction_set);
+    if (kernels == nullptr) {
+        return false;
+    }
+    active_kernels.store(kernels, memory_order_release);
+    return true;
+}
+
+void simd::sum(const float * const *inputs, uint32_t input_count, float *output, uint32_t count) {
+    current_kernels()->sum(inputs, input_count, output, count);
+}
+
+void simd::scaled_add(const float *input, float gain, float *output, uint32_t count) {
+    current_kernels()->scaled_add(input, gain, output, count);
+}
+
+void simd::gain_ramp(const float *input, float start_gain, float end_gain, float *output, uint32_t count) {
+    current_kernels()->gain_ramp(input, start_gain, end_gain, output, count);
+}
+
+void simd::clamp(const float *input, float min, float max, float *output, uint32_t count) {
+    current_kernels()->clamp(input, min, max, output, count);
+}
+
+void simd::float_to_int16(const float *input, int16_t *output, uint32_t count) {
+    current_kernels()->float_to_int16(input, output, count);
+}
+
+void simd::int16_to_float(const int16_t *input, float *output, uint32_t count) {
+    current_kernels()->int16_to_float(input, output, count);
+}
+
+void simd::float_to_int24(const float *input, int32_t *output, uint32_t count) {
+    current_kernels()->float_to_int24(input, output, count);
+}
+
+void simd::int24_to_float(const int32_t *input, float *output, uint32_t count) {
+    current_kernels()->int24_to_float(input, output, count);
+}
+
+void simd::interleave(
+    const float *planar, uint32_t stride, uint32_t channel_count, uint32_t frame_count, float *interleaved
+) {
+    current_kernels()->interleave(planar, stride, channel_count, frame_count, interleaved);
+}
+
+void simd::deinterleave(
+    const float *interleaved, uint32_t channel_count, uint32_t frame_count, float *planar, uint32_t stride
+) {
+    current_kernels()->deinterleave(interleaved, channel_count, frame_count, planar, stride);
+}
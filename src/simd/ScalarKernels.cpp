@@ -0,0 +1,116 @@
+#include "KernelTables.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace soundstone;
+using namespace soundstone::simd;
+using namespace std;
+
+namespace {
+    void sum_scalar(const float * const *inputs, uint32_t input_count, float *output, uint32_t count) {
+        if (input_count == 0) {
+            fill_n(output, count, 0.0f);
+            return;
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            float total = inputs[0][i];
+            for (uint32_t input = 1; input < input_count; ++input) {
+                total += inputs[input][i];
+            }
+            output[i] = total;
+        }
+    }
+
+    void scaled_add_scalar(const float *input, float gain, float *output, uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i) {
+            output[i] = output[i] + input[i] * gain;
+        }
+    }
+
+    void gain_ramp_scalar(const float *input, float start_gain, float end_gain, float *output, uint32_t count) {
+        float step = (end_gain - start_gain) / static_cast<float>(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            output[i] = input[i] * (start_gain + step * static_cast<float>(i));
+        }
+    }
+
+    void clamp_scalar(const float *input, float min, float max, float *output, uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i) {
+            float value = input[i] < min ? min : input[i];
+            output[i] = value > max ? max : value;
+        }
+    }
+
+    // Rounds to nearest even, like the conversion instructions do by default.
+    template <typename Integer>
+    void float_to_integer(
+        const float *input, Integer *output, uint32_t count, float scale, float min, float max
+    ) {
+        for (uint32_t i = 0; i < count; ++i) {
+            float value = input[i] * scale;
+            value = value < min ? min : value;
+            value = value > max ? max : value;
+            output[i] = static_cast<Integer>(lrintf(value));
+        }
+    }
+
+    template <typename Integer>
+    void integer_to_float(const Integer *input, float *output, uint32_t count, float scale) {
+        float inverse_scale = 1.0f / scale;
+        for (uint32_t i = 0; i < count; ++i) {
+            output[i] = static_cast<float>(input[i]) * inverse_scale;
+        }
+    }
+
+    void float_to_int16_scalar(const float *input, int16_t *output, uint32_t count) {
+        float_to_integer(input, output, count, INT16_SCALE, INT16_MIN_FLOAT, INT16_MAX_FLOAT);
+    }
+
+    void int16_to_float_scalar(const int16_t *input, float *output, uint32_t count) {
+        integer_to_float(input, output, count, INT16_SCALE);
+    }
+
+    void float_to_int24_scalar(const float *input, int32_t *output, uint32_t count) {
+        float_to_integer(input, output, count, INT24_SCALE, INT24_MIN_FLOAT, INT24_MAX_FLOAT);
+    }
+
+    void int24_to_float_scalar(const int32_t *input, float *output, uint32_t count) {
+        integer_to_float(input, output, count, INT24_SCALE);
+    }
+
+    void interleave_scalar(
+        const float *planar, uint32_t stride, uint32_t channel_count, uint32_t frame_count, float *interleaved
+    ) {
+        for (uint32_t channel = 0; channel < channel_count; ++channel) {
+            const float *source = planar + static_cast<size_t>(channel) * stride;
+            for (uint32_t i = 0; i < frame_count; ++i) {
+                interleaved[static_cast<size_t>(i) * channel_count + channel] = source[i];
+            }
+        }
+    }
+
+    void deinterleave_scalar(
+        const float *interleaved, uint32_t channel_count, uint32_t frame_count, float *planar, uint32_t stride
+    ) {
+        for (uint32_t channel = 0; channel < channel_count; ++channel) {
+            float *destination = planar + static_cast<size_t>(channel) * stride;
+            for (uint32_t i = 0; i < frame_count; ++i) {
+                destination[i] = interleaved[static_cast<size_t>(i) * channel_count + channel];
+            }
+        }
+    }
+}
+
+const KernelTable soundstone::simd::SCALAR_KERNELS = {
+    sum_scalar,
+    scaled_add_scalar,
+    gain_ramp_scalar,
+    clamp_scalar,
+    float_to_int16_scalar,
+    int16_to_float_scalar,
+    float_to_int24_scalar,
+    int24_to_float_scalar,
+    interleave_scalar,
+    deinterleave_scalar
+};
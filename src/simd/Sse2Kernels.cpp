@@ -0,0 +1,199 @@
+#include "KernelTables.hpp"
+
+#if defined(SOUNDSTONE_SIMD_X86)
+#include <emmintrin.h>
+
+using namespace soundstone;
+using namespace soundstone::simd;
+
+namespace {
+    SOUNDSTONE_TARGET("sse2")
+    void sum_sse2(const float * const *inputs, uint32_t input_count, float *output, uint32_t count) {
+        if (input_count == 0) {
+            SCALAR_KERNELS.sum(inputs, input_count, output, count);
+            return;
+        }
+
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 total = _mm_loadu_ps(inputs[0] + i);
+            for (uint32_t input = 1; input < input_count; ++input) {
+                total = _mm_add_ps(total, _mm_loadu_ps(inputs[input] + i));
+            }
+            _mm_storeu_ps(output + i, total);
+        }
+        for (; i < count; ++i) {
+            float total = inputs[0][i];
+            for (uint32_t input = 1; input < input_count; ++input) {
+                total += inputs[input][i];
+            }
+            output[i] = total;
+        }
+    }
+
+    SOUNDSTONE_TARGET("sse2")
+    void scaled_add_sse2(const float *input, float gain, float *output, uint32_t count) {
+        __m128 gains = _mm_set1_ps(gain);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 scaled = _mm_mul_ps(_mm_loadu_ps(input + i), gains);
+            _mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), scaled));
+        }
+        SCALAR_KERNELS.scaled_add(input + i, gain, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("sse2")
+    void gain_ramp_sse2(const float *input, float start_gain, float end_gain, float *output, uint32_t count) {
+        float step = (end_gain - start_gain) / static_cast<float>(count);
+        __m128 starts = _mm_set1_ps(start_gain);
+        __m128 steps = _mm_set1_ps(step);
+        __m128i offsets = _mm_setr_epi32(0, 1, 2, 3);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 indices = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(static_cast<int32_t>(i)), offsets));
+            __m128 gains = _mm_add_ps(starts, _mm_mul_ps(steps, indices));
+            _mm_storeu_ps(output + i, _mm_mul_ps(_mm_loadu_ps(input + i), gains));
+        }
+        for (; i < count; ++i) {
+            output[i] = input[i] * (start_gain + step * static_cast<float>(i));
+        }
+    }
+
+    // The limit comes first in max and min, so NaNs pass through like they do in the scalar kernels.
+    SOUNDSTONE_TARGET("sse2")
+    __m128 clamp_vector(__m128 values, __m128 mins, __m128 maxes) {
+        return _mm_min_ps(maxes, _mm_max_ps(mins, values));
+    }
+
+    SOUNDSTONE_TARGET("sse2")
+    void clamp_sse2(const float *input, float min, float max, float *output, uint32_t count) {
+        __m128 mins = _mm_set1_ps(min);
+        __m128 maxes = _mm_set1_ps(max);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(output + i, clamp_vector(_mm_loadu_ps(input + i), mins, maxes));
+        }
+        SCALAR_KERNELS.clamp(input + i, min, max, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("sse2")
+    __m128i float_to_integer_vector(const float *input, __m128 scales, __m128 mins, __m128 maxes) {
+        return _mm_cvtps_epi32(clamp_vector(_mm_mul_ps(_mm_loadu_ps(input), scales), mins, maxes));
+    }
+
+    SOUNDSTONE_TARGET("sse2")
+    void float_to_int16_sse2(const float *input, int16_t *output, uint32_t count) {
+        __m128 scales = _mm_set1_ps(INT16_SCALE);
+        __m128 mins = _mm_set1_ps(INT16_MIN_FLOAT);
+        __m128 maxes = _mm_set1_ps(INT16_MAX_FLOAT);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i low = float_to_integer_vector(input + i, scales, mins, maxes);
+            __m128i high = float_to_integer_vector(input + i + 4, scales, mins, maxes);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_packs_epi32(low, high));
+        }
+        SCALAR_KERNELS.float_to_int16(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("sse2")
+    void int16_to_float_sse2(const int16_t *input, float *output, uint32_t count) {
+        __m128 inverse_scales = _mm_set1_ps(1.0f / INT16_SCALE);
+        uint32_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+            // Sign extend by putting each value in the high half of a 32 bit lane and shifting it down.
+            __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+            __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16);
+            _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(low), inverse_scales));
+            _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), inverse_scales));
+        }
+        SCALAR_KERNELS.int16_to_float(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("sse2")
+    void float_to_int24_sse2(const float *input, int32_t *output, uint32_t count) {
+        __m128 scales = _mm_set1_ps(INT24_SCALE);
+        __m128 mins = _mm_set1_ps(INT24_MIN_FLOAT);
+        __m128 maxes = _mm_set1_ps(INT24_MAX_FLOAT);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i values = float_to_integer_vector(input + i, scales, mins, maxes);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), values);
+        }
+        SCALAR_KERNELS.float_to_int24(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("sse2")
+    void int24_to_float_sse2(const int32_t *input, float *output, uint32_t count) {
+        __m128 inverse_scales = _mm_set1_ps(1.0f / INT24_SCALE);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+            _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(values), inverse_scales));
+        }
+        SCALAR_KERNELS.int24_to_float(input + i, output + i, count - i);
+    }
+
+    SOUNDSTONE_TARGET("sse2")
+    void interleave_sse2(
+        const float *planar, uint32_t stride, uint32_t channel_count, uint32_t frame_count, float *interleaved
+    ) {
+        if (channel_count != 2) {
+            SCALAR_KERNELS.interleave(planar, stride, channel_count, frame_count, interleaved);
+            return;
+        }
+
+        const float *left = planar;
+        const float *right = planar + stride;
+        uint32_t i = 0;
+        for (; i + 4 <= frame_count; i += 4) {
+            __m128 l = _mm_loadu_ps(left + i);
+            __m128 r = _mm_loadu_ps(right + i);
+            _mm_storeu_ps(interleaved + i * 2, _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(interleaved + i * 2 + 4, _mm_unpackhi_ps(l, r));
+        }
+        for (; i < frame_count; ++i) {
+            interleaved[i * 2] = left[i];
+            interleaved[i * 2 + 1] = right[i];
+        }
+    }
+
+    SOUNDSTONE_TARGET("sse2")
+    void deinterleave_sse2(
+        const float *interleaved, uint32_t channel_count, uint32_t frame_count, float *planar, uint32_t stride
+    ) {
+        if (channel_count != 2) {
+            SCALAR_KERNELS.deinterleave(interleaved, channel_count, frame_count, planar, stride);
+            return;
+        }
+
+        float *left = planar;
+        float *right = planar + stride;
+        uint32_t i = 0;
+        for (; i + 4 <= frame_count; i += 4) {
+            __m128 first = _mm_loadu_ps(interleaved + i * 2);
+            __m128 second = _mm_loadu_ps(interleaved + i * 2 + 4);
+            _mm_storeu_ps(left + i, _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(right + i, _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+        for (; i < frame_count; ++i) {
+            left[i] = interleaved[i * 2];
+            right[i] = interleaved[i * 2 + 1];
+        }
+    }
+}
+
+const KernelTable soundstone::simd::SSE2_KERNELS = {
+    sum_sse2,
+    scaled_add_sse2,
+    gain_ramp_sse2,
+    clamp_sse2,
+    float_to_int16_sse2,
+    int16_to_float_sse2,
+    float_to_int24_sse2,
+    int24_to_float_sse2,
+    interleave_sse2,
+    deinterleave_sse2
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include <soundstone/AlignedArena.hpp>
+#include <cstdint>
+
+using namespace soundstone;
+using namespace std;
+
+TEST(AlignedArenaTests, TestBuffersArePaddedToTheAlignment) {
+    AlignedArena arena;
+    ASSERT_EQ(arena.reserve(1), 0);
+    ASSERT_EQ(arena.reserve(AlignedArena::FLOATS_PER_ALIGNMENT), AlignedArena::FLOATS_PER_ALIGNMENT);
+    ASSERT_EQ(arena.reserve(AlignedArena::FLOATS_PER_ALIGNMENT + 1), AlignedArena::FLOATS_PER_ALIGNMENT * 2);
+    ASSERT_EQ(arena.size(), AlignedArena::FLOATS_PER_ALIGNMENT * 4);
+}
+
+TEST(AlignedArenaTests, TestBuffersAreAlignedAndZeroed) {
+    AlignedArena arena;
+    size_t first = arena.reserve(3);
+    size_t second = arena.reserve(100);
+    arena.allocate();
+
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(arena.at(first)) % AlignedArena::ALIGNMENT, 0);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(arena.at(second)) % AlignedArena::ALIGNMENT, 0);
+    for (size_t i = 0; i < arena.size(); ++i) {
+        ASSERT_EQ(arena.at(0)[i], 0.0f);
+    }
+}
+
+TEST(AlignedArenaTests, TestEmptyArenaCanBeAllocated) {
+    AlignedArena arena;
+    arena.allocate();
+    ASSERT_EQ(arena.size(), 0);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(arena.at(0)) % AlignedArena::ALIGNMENT, 0);
+}
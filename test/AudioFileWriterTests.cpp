@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <soundstone/AudioFileWriter.hpp>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace soundstone;
+using namespace std;
+
+namespace {
+    vector<unsigned char> read_file(const string &path) {
+        ifstream file(path, ios::binary);
+        return vector<unsigned char>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+
+    uint32_t read_uint32(const vector<unsigned char> &bytes, size_t offset) {
+        return static_cast<uint32_t>(bytes[offset]) | static_cast<uint32_t>(bytes[offset + 1]) << 8 |
+               static_cast<uint32_t>(bytes[offset + 2]) << 16 | static_cast<uint32_t>(bytes[offset + 3]) << 24;
+    }
+
+    float read_float(const vector<unsigned char> &bytes, size_t offset) {
+        uint32_t bits = read_uint32(bytes, offset);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+TEST(AudioFileWriterTests, TestRawFilesHoldInterleavedFrames) {
+    string path = testing::TempDir() + "soundstone_writer.raw";
+    AudioFileWriter writer;
+    ASSERT_TRUE(writer.open(path, AudioFileWriter::Format::RAW, 2, 48000));
+
+    const float interleaved[] = {1.0f, 2.0f, 3.0f, 4.0f};
+    const float planar[] = {5.0f, 7.0f, 6.0f, 8.0f};
+    writer.write(interleaved, 2);
+    writer.write_planar(planar, 2, 2);
+    ASSERT_EQ(writer.frame_count(), 4);
+    ASSERT_TRUE(writer.close());
+
+    vector<unsigned char> bytes = read_file(path);
+    ASSERT_EQ(bytes.size(), 8 * sizeof(float));
+    for (size_t i = 0; i < 8; ++i) {
+        ASSERT_EQ(read_float(bytes, i * sizeof(float)), static_cast<float>(i + 1));
+    }
+}
+
+TEST(AudioFileWriterTests, TestWavHeaderDescribesTheFrames) {
+    string path = testing::TempDir() + "soundstone_writer.wav";
+    AudioFileWriter writer;
+    ASSERT_TRUE(writer.open(path, AudioFileWriter::Format::WAV, 3, 44100));
+
+    vector<float> frames(3 * 10, 0.5f);
+    writer.write(frames.data(), 10);
+    ASSERT_TRUE(writer.close());
+
+    vector<unsigned char> bytes = read_file(path);
+    ASSERT_EQ(bytes.size(), 58 + frames.size() * sizeof(float));
+    ASSERT_EQ(string(bytes.begin(), bytes.begin() + 4), "RIFF");
+    ASSERT_EQ(read_uint32(bytes, 4), bytes.size() - 8);
+    ASSERT_EQ(string(bytes.begin() + 8, bytes.begin() + 16), "WAVEfmt ");
+    ASSERT_EQ(read_uint32(bytes, 20) & 0xFFFF, 3);
+    ASSERT_EQ(read_uint32(bytes, 20) >> 16, 3);
+    ASSERT_EQ(read_uint32(bytes, 24), 44100);
+    ASSERT_EQ(read_uint32(bytes, 28), 44100 * 3 * sizeof(float));
+    ASSERT_EQ(read_uint32(bytes, 46), 10);
+    ASSERT_EQ(string(bytes.begin() + 50, bytes.begin() + 54), "data");
+    ASSERT_EQ(read_uint32(bytes, 54), frames.size() * sizeof(float));
+    ASSERT_EQ(read_float(bytes, 58), 0.5f);
+}
+
+TEST(AudioFileWriterTests, TestWritesLargerThanTheBufferAreKept) {
+    string path = testing::TempDir() + "soundstone_writer_large.raw";
+    AudioFileWriter writer;
+    ASSERT_TRUE(writer.open(path, AudioFileWriter::Format::RAW, 1, 48000));
+
+    vector<float> frames(AudioFileWriter::BUFFER_FRAMES * 2 + 3);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        frames[i] = static_cast<float>(i);
+    }
+    writer.write(frames.data(), 1);
+    writer.write(frames.data() + 1, static_cast<uint32_t>(frames.size() - 1));
+    ASSERT_TRUE(writer.close());
+
+    vector<unsigned char> bytes = read_file(path);
+    ASSERT_EQ(bytes.size(), frames.size() * sizeof(float));
+    for (size_t i = 0; i < frames.size(); ++i) {
+        ASSERT_EQ(read_float(bytes, i * sizeof(float)), frames[i]);
+    }
+}
+
+TEST(AudioFileWriterTests, TestOpenFailsWithoutADirectory) {
+    AudioFileWriter writer;
+    ASSERT_FALSE(writer.open(testing::TempDir() + "missing/soundstone.wav", AudioFileWriter::Format::WAV, 2, 48000));
+    ASSERT_FALSE(writer.is_open());
+
+    const float frame[] = {1.0f, 2.0f};
+    writer.write(frame, 1);
+    ASSERT_EQ(writer.frame_count(), 0);
+    ASSERT_FALSE(writer.close());
+}
@@ -1,10 +1,17 @@
 #include <soundstone/AudioProcessor.hpp>
 
 #include "mocks/MockSampler.hpp"
+#include "util/DumbSampler.hpp"
+#include "util/ChannelSampler.hpp"
+#include "util/SilenceSampler.hpp"
+#include "util/SumSampler.hpp"
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <memory>
+#include <vector>
+#include <thread>
+#include <atomic>
 
 using namespace soundstone;
 using namespace soundstone_test;
@@ -25,6 +32,7 @@ TEST_P(AudioProcessorTests, TestUpdateWithZeroSamplers)
 {
     AudioProcessor processor;
     processor.set_thread_count(GetParam());
+    processor.wait_for_changes();
     processor.update(1024);
 }
 
@@ -41,6 +49,7 @@ TEST_P(AudioProcessorTests, TestRemovedSamplerAreNotCalled)
     processor.add_module(&sampler2);
     processor.set_input(&sampler1, 0, &sampler2);
     processor.remove_module(&sampler2);
+    processor.wait_for_changes();
     processor.update(1);
 }
 
@@ -57,9 +66,30 @@ TEST_P(AudioProcessorTests, TestSimpleRoutingWorks)
     processor.add_module(&sampler1);
     processor.add_module(&sampler2);
     processor.set_input(&sampler2, 0, &sampler1);
+    processor.wait_for_changes();
     processor.update(1);
 }
 
+TEST_P(AudioProcessorTests, TestRoutingSurvivesRepeatedUpdates)
+{
+    // Module 1 -> Module 2, updated with a growing number of samples so the buffers are reallocated.
+    NiceMock<MockSampler> sampler1, sampler2;
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    EXPECT_CALL(sampler1, commit()).Times(3);
+    EXPECT_CALL(sampler1, sample(_, NotNull(), _)).Times(3).WillRepeatedly(DoAll(SetArgPointee<1>(1.0f)));
+    EXPECT_CALL(sampler2, sample(Pointee(Pointee(1.0f)), NotNull(), _)).Times(3);
+
+    processor.add_module(&sampler2);
+    processor.add_module(&sampler1);
+    processor.set_input(&sampler2, 0, &sampler1);
+    processor.wait_for_changes();
+    processor.update(1);
+    processor.update(1);
+    processor.update(4);
+}
+
 MATCHER_P2(PointeeAtIndex, n, m, "") {
     return Matches(m)(arg[n]);
 }
@@ -102,6 +132,7 @@ TEST_P(AudioProcessorTests, TestRoutingMultipleInputsToSamplerWithDifferentInput
     processor.add_module(&sampler3);
     processor.set_input(&sampler3, 0, &sampler1);
     processor.set_input(&sampler3, 1, &sampler2);
+    processor.wait_for_changes();
     processor.update(1);
 }
 
@@ -141,9 +172,570 @@ TEST_P(AudioProcessorTests, TestRoutingDiamondWorks)
     processor.set_input(&sampler4, 1, &sampler3);
     processor.set_input(&sampler2, 0, &sampler1);
     processor.set_input(&sampler3, 0, &sampler1);
+    processor.wait_for_changes();
+    processor.update(1);
+}
+
+TEST_P(AudioProcessorTests, TestRoutingWorksWithWorkStealing)
+{
+    // Module 1 -> Module 2 -> Module 3
+    NiceMock<MockSampler> sampler1, sampler2, sampler3;
+    AudioProcessor processor;
+    processor.set_scheduler(PoolParty::Scheduler::WORK_STEALING);
+    processor.set_wait_policy(PoolParty::WaitPolicy(chrono::nanoseconds(0), chrono::nanoseconds(0)));
+    processor.set_thread_count(GetParam());
+
+    EXPECT_CALL(sampler1, sample(_, NotNull(), 1)).Times(2).WillRepeatedly(DoAll(SetArgPointee<1>(1.0f)));
+    EXPECT_CALL(sampler2, sample(Pointee(Pointee(1.0f)), NotNull(), 1)).Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(2.0f)));
+    EXPECT_CALL(sampler3, sample(Pointee(Pointee(2.0f)), NotNull(), 1)).Times(2);
+
+    processor.add_module(&sampler3);
+    processor.add_module(&sampler2);
+    processor.add_module(&sampler1);
+    processor.set_input(&sampler3, 0, &sampler2);
+    processor.set_input(&sampler2, 0, &sampler1);
+    processor.wait_for_changes();
+    processor.update(1);
+    processor.update(1);
+}
+
+
+TEST_P(AudioProcessorTests, TestCyclicRouteIsRejected)
+{
+    // Module 1 -> Module 2, then routing Module 2 back into Module 1 is ignored.
+    NiceMock<MockSampler> sampler1, sampler2;
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    EXPECT_CALL(sampler1, sample(Pointee(NotNull()), NotNull(), 1)).WillOnce(DoAll(SetArgPointee<1>(1.0f)));
+    EXPECT_CALL(sampler2, sample(Pointee(Pointee(1.0f)), NotNull(), 1)).Times(1);
+
+    processor.add_module(&sampler2);
+    processor.add_module(&sampler1);
+    processor.set_input(&sampler2, 0, &sampler1);
+    processor.set_input(&sampler1, 0, &sampler2);
+    processor.set_input(&sampler1, 1, &sampler1);
+    processor.wait_for_changes();
+    ASSERT_EQ(processor.cyclic_route_count(), 2);
+    processor.update(1);
+
+    // Unrouting can't create a cycle, even when what it names is routed the other way.
+    processor.set_input(&sampler1, 0, nullptr);
+    processor.unmix_input(&sampler1, 0, &sampler2);
+    processor.wait_for_changes();
+    ASSERT_EQ(processor.cyclic_route_count(), 2);
+}
+
+
+TEST_P(AudioProcessorTests, TestLongChainWithSharedBuffersWorks)
+{
+    // Module 1 -> Module 2 -> ... -> Module 6, where each module outputs its input plus one.
+    const uint32_t sampler_count = 6;
+    NiceMock<MockSampler> samplers[sampler_count];
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    for (uint32_t i = 0; i < sampler_count; ++i) {
+        if (i == 0) {
+            EXPECT_CALL(samplers[i], sample(_, NotNull(), 1)).Times(2)
+                .WillRepeatedly(DoAll(SetArgPointee<1>(1.0f)));
+        } else {
+            EXPECT_CALL(samplers[i], sample(Pointee(Pointee(static_cast<float>(i))), NotNull(), 1)).Times(2)
+                .WillRepeatedly(DoAll(SetArgPointee<1>(static_cast<float>(i + 1))));
+        }
+        processor.add_module(&samplers[i]);
+    }
+    for (uint32_t i = 1; i < sampler_count; ++i) {
+        processor.set_input(&samplers[i], 0, &samplers[i - 1]);
+    }
+    processor.wait_for_changes();
+    processor.update(1);
+    processor.update(1);
+}
+
+
+TEST_P(AudioProcessorTests, TestIndependentChainsReadTheirOwnSources)
+{
+    // Source 1 -> Pass 1, Source 2 -> Pass 2 and Source 3 -> Pass 3. Sources all become ready before any pass, so
+    // the passes must not share a buffer with another chain's source.
+    const uint32_t chain_count = 3;
+    vector<unique_ptr<ChannelSampler>> sources, passes;
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    for (uint32_t i = 0; i < chain_count; ++i) {
+        sources.emplace_back(new ChannelSampler(1, 1, static_cast<float>(i + 1)));
+        passes.emplace_back(new ChannelSampler(1, 1, 0.0f));
+        processor.add_module(sources[i].get());
+        processor.add_module(passes[i].get());
+        processor.route(sources[i].get()).to(passes[i].get());
+    }
+    processor.wait_for_changes();
+    processor.update(4);
+
+    for (uint32_t i = 0; i < chain_count; ++i) {
+        ASSERT_EQ(passes[i]->last_input, vector<float>(4, static_cast<float>(i + 1)));
+    }
+}
+
+TEST_P(AudioProcessorTests, TestChangesArePickedUpByTheNextUpdate)
+{
+    NiceMock<MockSampler> sampler1, sampler2;
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    EXPECT_CALL(sampler1, sample(_, NotNull(), 1)).Times(2).WillRepeatedly(DoAll(SetArgPointee<1>(1.0f)));
+    EXPECT_CALL(sampler2, sample(Pointee(Pointee(1.0f)), NotNull(), 1)).Times(1);
+
+    processor.add_module(&sampler1);
+    processor.wait_for_changes();
+    processor.update(1);
+
+    processor.add_module(&sampler2);
+    processor.set_input(&sampler2, 0, &sampler1);
+    processor.wait_for_changes();
     processor.update(1);
 }
 
+TEST_P(AudioProcessorTests, TestLongUpdatesAreProcessedInBlocks)
+{
+    NiceMock<MockSampler> sampler;
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    EXPECT_CALL(sampler, commit()).Times(1);
+    EXPECT_CALL(sampler, sample(_, NotNull(), AudioProcessor::DEFAULT_BLOCK_SIZE)).Times(3);
+    EXPECT_CALL(sampler, sample(_, NotNull(), 32)).Times(1);
+
+    processor.add_module(&sampler);
+    processor.wait_for_changes();
+    processor.update(AudioProcessor::DEFAULT_BLOCK_SIZE * 3 + 32);
+}
+
+TEST_P(AudioProcessorTests, TestBlockSizeCanBeChanged)
+{
+    NiceMock<MockSampler> sampler;
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+    processor.set_block_size(64);
+
+    EXPECT_CALL(sampler, commit()).Times(2);
+    EXPECT_CALL(sampler, sample(_, NotNull(), 64)).Times(2);
+    EXPECT_CALL(sampler, sample(_, NotNull(), 36)).Times(1);
+    EXPECT_CALL(sampler, sample(_, NotNull(), 128)).Times(1);
+
+    processor.add_module(&sampler);
+    processor.wait_for_changes();
+    processor.update(100);
+
+    processor.set_block_size(128);
+    processor.update(192);
+}
+
+TEST_P(AudioProcessorTests, TestBuffersAreAligned)
+{
+    NiceMock<MockSampler> source, destination;
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    auto is_aligned = [](const void *buffer) {
+        return reinterpret_cast<uintptr_t>(buffer) % Module::BUFFER_ALIGNMENT == 0;
+    };
+    // The first input is routed, the second reads from the null buffer.
+    auto expect_aligned = [&](const float * const *input_buffers, float *output_buffer, uint32_t) {
+        EXPECT_TRUE(is_aligned(input_buffers[0]));
+        EXPECT_TRUE(is_aligned(input_buffers[1]));
+        EXPECT_TRUE(is_aligned(output_buffer));
+    };
+    EXPECT_CALL(source, sample(_, _, 20)).WillOnce(Invoke(expect_aligned));
+    EXPECT_CALL(destination, sample(_, _, 20)).WillOnce(Invoke(expect_aligned));
+
+    processor.add_module(&source);
+    processor.add_module(&destination);
+    processor.set_input(&destination, 0, &source);
+    processor.wait_for_changes();
+    processor.update(20);
+}
+
+TEST_P(AudioProcessorTests, TestChangingTheGraphWhileUpdating)
+{
+    const uint32_t sampler_count = 8;
+    DumbSampler samplers[sampler_count];
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+    for (DumbSampler &sampler : samplers) {
+        processor.add_module(&sampler);
+    }
+
+    atomic<bool> is_done(false);
+    thread editor([&]{
+        for (uint32_t i = 0; !is_done; ++i) {
+            processor.set_input(&samplers[(i + 1) % sampler_count], 0, &samplers[i % sampler_count]);
+            processor.set_input(&samplers[(i + 1) % sampler_count], 0, nullptr);
+            if (i % 16 == 0) {
+                this_thread::yield();
+            }
+        }
+    });
+
+    for (uint32_t i = 0; i < 200; ++i) {
+        processor.update(64);
+    }
+    is_done = true;
+    editor.join();
+    processor.wait_for_changes();
+    processor.update(64);
+}
+
+
+TEST_P(AudioProcessorTests, TestChangingTheSchedulerWhileUpdating)
+{
+    // Source -> Sum <- Source, with the scheduler switched back and forth between updates.
+    const uint32_t source_count = 8;
+    DumbSampler sources[source_count];
+    SumSampler sum(1);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+    processor.add_module(&sum);
+    for (DumbSampler &source : sources) {
+        processor.add_module(&source);
+        processor.route(&source).mix_into(&sum);
+    }
+    processor.wait_for_changes();
+
+    atomic<bool> is_done(false);
+    thread switcher([&]{
+        for (uint32_t i = 0; !is_done; ++i) {
+            processor.set_scheduler(i % 2 == 0 ? PoolParty::Scheduler::WORK_STEALING : PoolParty::Scheduler::SHARED);
+            this_thread::yield();
+        }
+    });
+
+    for (uint32_t i = 0; i < 500; ++i) {
+        processor.update(256);
+    }
+    is_done = true;
+    switcher.join();
+    processor.wait_for_changes();
+    processor.update(256);
+}
+
+TEST_P(AudioProcessorTests, TestChangingThreadSettingsWhileUpdating)
+{
+    // Source -> Chain 1 -> ... -> Chain 8, with the processing threads restarted between and during updates.
+    const uint32_t chain_length = 8;
+    vector<unique_ptr<SumSampler>> chain;
+    DumbSampler source;
+    AudioProcessor processor;
+    processor.add_module(&source);
+    for (uint32_t i = 0; i < chain_length; ++i) {
+        chain.emplace_back(new SumSampler(1));
+        processor.add_module(chain.back().get());
+        processor.route(i == 0 ? static_cast<Module *>(&source) : chain[i - 1].get()).to(chain.back().get());
+    }
+    processor.wait_for_changes();
+
+    atomic<bool> is_done(false);
+    thread changer([&]{
+        for (uint32_t i = 0; !is_done; ++i) {
+            switch (i % 3) {
+                case 0:
+                    processor.set_thread_count(1 + i % GetParam());
+                    break;
+                case 1:
+                    processor.set_wait_policy(PoolParty::WaitPolicy(chrono::nanoseconds(i % 2)));
+                    break;
+                default:
+                    processor.set_thread_config(ThreadConfig());
+                    break;
+            }
+            this_thread::yield();
+        }
+    });
+
+    for (uint32_t i = 0; i < 500; ++i) {
+        processor.update(256);
+    }
+    is_done = true;
+    changer.join();
+    processor.wait_for_changes();
+    processor.update(256);
+}
+
+TEST_P(AudioProcessorTests, TestMatchingChannelsArePassedThrough)
+{
+    ChannelSampler source(2, 1, 1.0f), destination(2, 2, 0.0f);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&source);
+    processor.add_module(&destination);
+    processor.set_input(&destination, 0, &source);
+    processor.wait_for_changes();
+    processor.update(3);
+
+    vector<float> expected = {1, 1, 1, 2, 2, 2};
+    ASSERT_EQ(destination.last_input, expected);
+}
+
+TEST_P(AudioProcessorTests, TestMonoIsCopiedToEveryChannel)
+{
+    ChannelSampler source(1, 1, 3.0f), destination(1, 3, 0.0f);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&source);
+    processor.add_module(&destination);
+    processor.set_input(&destination, 0, &source);
+    processor.wait_for_changes();
+    processor.update(2);
+
+    vector<float> expected = {3, 3, 3, 3, 3, 3};
+    ASSERT_EQ(destination.last_input, expected);
+}
+
+TEST_P(AudioProcessorTests, TestChannelsAreAveragedDownToMono)
+{
+    ChannelSampler source(2, 1, 1.0f), destination(1, 1, 0.0f);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&source);
+    processor.add_module(&destination);
+    processor.set_input(&destination, 0, &source);
+    processor.wait_for_changes();
+    processor.update(2);
+
+    vector<float> expected = {1.5f, 1.5f};
+    ASSERT_EQ(destination.last_input, expected);
+}
+
+TEST_P(AudioProcessorTests, TestMissingChannelsAreSilent)
+{
+    ChannelSampler source(2, 1, 1.0f), destination(1, 3, 0.0f), unrouted(1, 2, 0.0f);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&source);
+    processor.add_module(&destination);
+    processor.add_module(&unrouted);
+    processor.set_input(&destination, 0, &source);
+    processor.wait_for_changes();
+    processor.update(2);
+
+    vector<float> expected = {1, 1, 2, 2, 0, 0};
+    ASSERT_EQ(destination.last_input, expected);
+    vector<float> expected_unrouted = {0, 0, 0, 0};
+    ASSERT_EQ(unrouted.last_input, expected_unrouted);
+}
+
+
+TEST_P(AudioProcessorTests, TestSilencePreservingModulesAreSkippedOnSilence)
+{
+    SilenceSampler source(false), effect(true), listener(false);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&source);
+    processor.add_module(&effect);
+    processor.add_module(&listener);
+    processor.route(&source).to(&effect);
+    processor.route(&effect).to(&listener);
+    processor.wait_for_changes();
+
+    source.is_silent = true;
+    processor.update(4);
+    ASSERT_EQ(source.sample_count, 1);
+    ASSERT_EQ(effect.sample_count, 0);
+    ASSERT_EQ(listener.sample_count, 1);
+    ASSERT_TRUE(listener.first_input_was_silent);
+    ASSERT_EQ(listener.last_input, vector<float>(4, 0.0f));
+
+    source.is_silent = false;
+    processor.update(4);
+    ASSERT_EQ(effect.sample_count, 1);
+    ASSERT_FALSE(effect.first_input_was_silent);
+    ASSERT_EQ(effect.last_input, vector<float>(4, 1.0f));
+    ASSERT_FALSE(listener.first_input_was_silent);
+}
+
+TEST_P(AudioProcessorTests, TestUnroutedInputsAreSilent)
+{
+    SilenceSampler effect(true), generator(false);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&effect);
+    processor.add_module(&generator);
+    processor.wait_for_changes();
+    processor.update(4);
+
+    ASSERT_EQ(effect.sample_count, 0);
+    ASSERT_EQ(generator.sample_count, 1);
+    ASSERT_TRUE(generator.first_input_was_silent);
+}
+
+
+TEST_P(AudioProcessorTests, TestModulesCanHaveHundredsOfInputs)
+{
+    const uint32_t source_count = 300;
+    vector<unique_ptr<ChannelSampler>> sources;
+    SumSampler bus(source_count + 1);
+    ChannelSampler listener(1, 1, 0.0f);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&bus);
+    processor.add_module(&listener);
+    processor.route(&bus).to(&listener);
+    for (uint32_t i = 0; i < source_count; ++i) {
+        sources.emplace_back(new ChannelSampler(1, 1, 1.0f));
+        processor.add_module(sources.back().get());
+        processor.route(sources.back().get()).to(&bus, i);
+    }
+    processor.wait_for_changes();
+    processor.update(2);
+
+    // The last input is left unrouted, and reads silence.
+    ASSERT_EQ(listener.last_input, vector<float>(2, static_cast<float>(source_count)));
+}
+
+TEST_P(AudioProcessorTests, TestRoutesPastTheInputCountAreIgnored)
+{
+    ChannelSampler source(1, 1, 1.0f), destination(1, 1, 0.0f);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&source);
+    processor.add_module(&destination);
+    processor.set_input(&destination, 1, &source);
+    processor.wait_for_changes();
+    processor.update(2);
+
+    ASSERT_EQ(destination.last_input, vector<float>(2, 0.0f));
+}
+
+
+TEST_P(AudioProcessorTests, TestRoutesIntoTheSameInputAreSummed)
+{
+    ChannelSampler source1(1, 1, 1.0f), source2(1, 1, 2.0f), destination(1, 1, 0.0f);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&source1);
+    processor.add_module(&source2);
+    processor.add_module(&destination);
+    processor.route(&source1).mix_into(&destination);
+    processor.route(&source2).mix_into(&destination, 0, 0.25f);
+    processor.wait_for_changes();
+    processor.update(2);
+    ASSERT_EQ(destination.last_input, vector<float>(2, 1.5f));
+
+    // Mixing an already mixed module changes its gain.
+    processor.route(&source2).mix_into(&destination, 0, 1.0f);
+    processor.wait_for_changes();
+    processor.update(2);
+    ASSERT_EQ(destination.last_input, vector<float>(2, 3.0f));
+
+    processor.unmix_input(&destination, 0, &source1);
+    processor.wait_for_changes();
+    processor.update(2);
+    ASSERT_EQ(destination.last_input, vector<float>(2, 2.0f));
+
+    // Setting the input replaces everything mixed into it.
+    processor.route(&source2).mix_into(&destination, 0, 0.5f);
+    processor.set_input(&destination, 0, &source1);
+    processor.wait_for_changes();
+    processor.update(2);
+    ASSERT_EQ(destination.last_input, vector<float>(2, 1.0f));
+}
+
+TEST_P(AudioProcessorTests, TestMixedSourcesAreConvertedToTheInputsChannels)
+{
+    ChannelSampler mono(1, 1, 1.0f), stereo(2, 1, 1.0f), destination(1, 2, 0.0f);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&mono);
+    processor.add_module(&stereo);
+    processor.add_module(&destination);
+    processor.route(&mono).mix_into(&destination);
+    processor.route(&stereo).mix_into(&destination, 0, 2.0f);
+    processor.wait_for_changes();
+    processor.update(2);
+
+    vector<float> expected = {3, 3, 5, 5};
+    ASSERT_EQ(destination.last_input, expected);
+}
+
+TEST_P(AudioProcessorTests, TestMixedInputsAreSilentWhenEverySourceIs)
+{
+    SilenceSampler source1(false), source2(false), listener(false);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&source1);
+    processor.add_module(&source2);
+    processor.add_module(&listener);
+    processor.route(&source1).mix_into(&listener);
+    processor.route(&source2).mix_into(&listener, 0, 0.5f);
+    processor.wait_for_changes();
+
+    source1.is_silent = true;
+    processor.update(2);
+    ASSERT_FALSE(listener.first_input_was_silent);
+    ASSERT_EQ(listener.last_input, vector<float>(2, 0.5f));
+
+    source2.is_silent = true;
+    processor.update(2);
+    ASSERT_TRUE(listener.first_input_was_silent);
+    ASSERT_EQ(listener.last_input, vector<float>(2, 0.0f));
+}
+
+#ifdef SOUNDSTONE_MODULE_STATS
+TEST_P(AudioProcessorTests, TestModulesAreTimedEveryBlock)
+{
+    SilenceSampler source(false), listener(false), unadded(false);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+    processor.set_block_size(16);
+
+    processor.add_module(&source);
+    processor.add_module(&listener);
+    processor.route(&source).to(&listener);
+    processor.wait_for_changes();
+    processor.update(48);
+
+    TimingWindow::Summary stats;
+    ASSERT_TRUE(processor.module_stats(&listener, stats));
+    ASSERT_EQ(stats.count, 3);
+    ASSERT_GE(stats.max, stats.mean);
+    ASSERT_GE(stats.max, stats.p99);
+    ASSERT_FALSE(processor.module_stats(&unadded, stats));
+
+    processor.remove_module(&listener);
+    processor.wait_for_changes();
+    ASSERT_FALSE(processor.module_stats(&listener, stats));
+    processor.update(16);
+}
+#else
+TEST_P(AudioProcessorTests, TestModulesAreNotTimedWithoutStats)
+{
+    SilenceSampler source(false);
+    AudioProcessor processor;
+    processor.set_thread_count(GetParam());
+
+    processor.add_module(&source);
+    processor.wait_for_changes();
+    processor.update(48);
+
+    TimingWindow::Summary stats;
+    ASSERT_FALSE(processor.module_stats(&source, stats));
+    ASSERT_EQ(stats.count, 0);
+    ASSERT_EQ(source.sample_count, 1);
+}
+#endif
 
 INSTANTIATE_TEST_SUITE_P(
     AudioProcessorTestsImpl,
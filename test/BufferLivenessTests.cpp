@@ -0,0 +1,120 @@
+#include <soundstone/BufferLiveness.hpp>
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace soundstone;
+using namespace std;
+
+// Check that no node writes a buffer while another node may still need its previous contents.
+static void assert_no_overlap(
+    const vector<vector<uint32_t>> &dependencies,
+    const vector<uint32_t> &buffer_indices,
+    BufferLiveness::Mode mode
+) {
+    uint32_t node_count = dependencies.size();
+    vector<vector<bool>> is_ancestor(node_count, vector<bool>(node_count, false));
+    for (uint32_t node = 0; node < node_count; ++node) {
+        for (uint32_t dependency : dependencies[node]) {
+            is_ancestor[node][dependency] = true;
+            for (uint32_t other = 0; other < node_count; ++other) {
+                if (is_ancestor[dependency][other]) {
+                    is_ancestor[node][other] = true;
+                }
+            }
+        }
+    }
+
+    for (uint32_t writer = 0; writer < node_count; ++writer) {
+        for (uint32_t node = 0; node < writer; ++node) {
+            if (buffer_indices[node] != buffer_indices[writer]) {
+                continue;
+            }
+            // Everything reading the earlier node's output, and the node itself, must be done before the writer runs.
+            vector<uint32_t> readers = { node };
+            for (uint32_t reader = node + 1; reader < node_count; ++reader) {
+                for (uint32_t dependency : dependencies[reader]) {
+                    if (dependency == node) {
+                        readers.push_back(reader);
+                    }
+                }
+            }
+            for (uint32_t reader : readers) {
+                if (mode == BufferLiveness::Mode::SEQUENTIAL) {
+                    ASSERT_LT(reader, writer);
+                } else {
+                    ASSERT_TRUE(is_ancestor[writer][reader]);
+                }
+            }
+        }
+    }
+}
+
+TEST(BufferLivenessTests, TestEmptyGraph) {
+    BufferLiveness liveness;
+    vector<uint32_t> buffer_indices;
+    ASSERT_EQ(0, liveness.assign({}, BufferLiveness::Mode::SEQUENTIAL, buffer_indices));
+    ASSERT_EQ(0, liveness.assign({}, BufferLiveness::Mode::CONCURRENT, buffer_indices));
+    ASSERT_TRUE(buffer_indices.empty());
+}
+
+TEST(BufferLivenessTests, TestChainUsesTwoBuffers) {
+    // 0 -> 1 -> 2 -> 3 -> 4
+    vector<vector<uint32_t>> dependencies = {{}, {0}, {1}, {2}, {3}};
+    BufferLiveness liveness;
+    vector<uint32_t> buffer_indices;
+
+    ASSERT_EQ(2, liveness.assign(dependencies, BufferLiveness::Mode::SEQUENTIAL, buffer_indices));
+    assert_no_overlap(dependencies, buffer_indices, BufferLiveness::Mode::SEQUENTIAL);
+
+    ASSERT_EQ(2, liveness.assign(dependencies, BufferLiveness::Mode::CONCURRENT, buffer_indices));
+    assert_no_overlap(dependencies, buffer_indices, BufferLiveness::Mode::CONCURRENT);
+}
+
+TEST(BufferLivenessTests, TestIndependentNodesShareOnlyWhenSequential) {
+    // Four voices with nothing reading them.
+    vector<vector<uint32_t>> dependencies = {{}, {}, {}, {}};
+    BufferLiveness liveness;
+    vector<uint32_t> buffer_indices;
+
+    ASSERT_EQ(1, liveness.assign(dependencies, BufferLiveness::Mode::SEQUENTIAL, buffer_indices));
+    ASSERT_EQ(4, liveness.assign(dependencies, BufferLiveness::Mode::CONCURRENT, buffer_indices));
+}
+
+TEST(BufferLivenessTests, TestWideGraphNeedsItsWidth) {
+    // Eight voices, each a chain of two modules, mixed into one module.
+    vector<vector<uint32_t>> dependencies;
+    vector<uint32_t> mixer_inputs;
+    for (uint32_t voice = 0; voice < 8; ++voice) {
+        dependencies.push_back({});
+        dependencies.push_back({static_cast<uint32_t>(dependencies.size() - 1)});
+        mixer_inputs.push_back(dependencies.size() - 1);
+    }
+    dependencies.push_back(mixer_inputs);
+
+    BufferLiveness liveness;
+    vector<uint32_t> buffer_indices;
+
+    uint32_t sequential_count = liveness.assign(dependencies, BufferLiveness::Mode::SEQUENTIAL, buffer_indices);
+    assert_no_overlap(dependencies, buffer_indices, BufferLiveness::Mode::SEQUENTIAL);
+    ASSERT_EQ(9, sequential_count);
+
+    uint32_t concurrent_count = liveness.assign(dependencies, BufferLiveness::Mode::CONCURRENT, buffer_indices);
+    assert_no_overlap(dependencies, buffer_indices, BufferLiveness::Mode::CONCURRENT);
+    ASSERT_EQ(16, concurrent_count);
+}
+
+TEST(BufferLivenessTests, TestDiamondIsSafeWhenConcurrent) {
+    //      1
+    // 0 <     > 3 -> 4
+    //      2
+    vector<vector<uint32_t>> dependencies = {{}, {0}, {0}, {1, 2}, {3}};
+    BufferLiveness liveness;
+    vector<uint32_t> buffer_indices;
+
+    ASSERT_EQ(3, liveness.assign(dependencies, BufferLiveness::Mode::SEQUENTIAL, buffer_indices));
+    assert_no_overlap(dependencies, buffer_indices, BufferLiveness::Mode::SEQUENTIAL);
+
+    ASSERT_EQ(3, liveness.assign(dependencies, BufferLiveness::Mode::CONCURRENT, buffer_indices));
+    assert_no_overlap(dependencies, buffer_indices, BufferLiveness::Mode::CONCURRENT);
+}
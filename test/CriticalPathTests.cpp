@@ -0,0 +1,61 @@
+#include <soundstone/CriticalPath.hpp>
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace soundstone;
+using namespace std;
+
+TEST(CriticalPathTests, TestEmptyGraph)
+{
+    vector<uint64_t> lengths = {1, 2};
+    CriticalPath::measure({}, {}, lengths);
+    ASSERT_TRUE(lengths.empty());
+}
+
+TEST(CriticalPathTests, TestChainOutranksAnExpensiveLeaf)
+{
+    // Voice (5) -> Mixer (1) and Chain 1 (2) -> Chain 2 (2) -> Chain 3 (2) -> Mixer.
+    vector<vector<uint32_t>> dependencies = {{}, {}, {1}, {2}, {0, 3}};
+    vector<uint64_t> costs = {5, 2, 2, 2, 1};
+    vector<uint64_t> lengths;
+
+    CriticalPath::measure(dependencies, costs, lengths);
+
+    ASSERT_EQ(lengths, vector<uint64_t>({6, 7, 5, 3, 1}));
+}
+
+TEST(CriticalPathTests, TestLongestBranchWins)
+{
+    // 0 -> 1 -> 3 and 0 -> 2 -> 3, with the branch through 1 costing more.
+    vector<vector<uint32_t>> dependencies = {{}, {0}, {0}, {1, 2}};
+    vector<uint64_t> costs = {1, 10, 3, 1};
+    vector<uint64_t> lengths;
+
+    CriticalPath::measure(dependencies, costs, lengths);
+
+    ASSERT_EQ(lengths, vector<uint64_t>({12, 11, 4, 1}));
+}
+
+TEST(CriticalPathTests, TestUnmeasuredNodesCostTheAverage)
+{
+    // 0 -> 1 and 2 -> 3, where 1 and 2 haven't been measured.
+    vector<vector<uint32_t>> dependencies = {{}, {0}, {}, {2}};
+    vector<uint64_t> costs = {10, 0, 0, 30};
+    vector<uint64_t> lengths;
+
+    CriticalPath::measure(dependencies, costs, lengths);
+
+    ASSERT_EQ(lengths, vector<uint64_t>({30, 20, 50, 30}));
+}
+
+TEST(CriticalPathTests, TestWithoutMeasurementsNodesAreRankedByHops)
+{
+    // 0 -> 1 -> 2, and 3 on its own.
+    vector<vector<uint32_t>> dependencies = {{}, {0}, {1}, {}};
+    vector<uint64_t> lengths;
+
+    CriticalPath::measure(dependencies, vector<uint64_t>(4, 0), lengths);
+
+    ASSERT_EQ(lengths, vector<uint64_t>({3, 2, 1, 1}));
+}
@@ -178,4 +178,96 @@ using namespace testing;
 //    DumbSampler sampler1;
 //    graph.add(&sampler1);
 //    EXPECT_DEATH(graph.add(&sampler1), "");
-//}
\ No newline at end of file
+//}
+TEST(DependencyGraphTest, TestChainIsResolvedInDependencyOrder)
+{
+    DependencyGraph<uint32_t> graph;
+    graph.add(1);
+    graph.add(2);
+    graph.add(3);
+    graph.add_dependency(1, 2);
+    graph.add_dependency(2, 3);
+
+    uint32_t count;
+    unique_ptr<uint32_t[]> order = graph.resolve(count);
+    ASSERT_NE(nullptr, order);
+    ASSERT_EQ(3, count);
+    ASSERT_EQ(3, order[0]);
+    ASSERT_EQ(2, order[1]);
+    ASSERT_EQ(1, order[2]);
+}
+
+TEST(DependencyGraphTest, TestDiamondIsResolvedInDependencyOrder)
+{
+    DependencyGraph<uint32_t> graph;
+    for (uint32_t i = 1; i <= 4; ++i) {
+        graph.add(i);
+    }
+    graph.add_dependency(1, 2);
+    graph.add_dependency(1, 3);
+    graph.add_dependency(2, 4);
+    graph.add_dependency(3, 4);
+
+    uint32_t count;
+    unique_ptr<uint32_t[]> order = graph.resolve(count);
+    ASSERT_NE(nullptr, order);
+    ASSERT_EQ(4, count);
+    unordered_map<uint32_t, uint32_t> positions;
+    for (uint32_t i = 0; i < count; ++i) {
+        positions[order[i]] = i;
+    }
+    ASSERT_EQ(4, positions.size());
+    ASSERT_LT(positions[4], positions[2]);
+    ASSERT_LT(positions[4], positions[3]);
+    ASSERT_LT(positions[2], positions[1]);
+    ASSERT_LT(positions[3], positions[1]);
+}
+
+TEST(DependencyGraphTest, TestCycleIsNotResolved)
+{
+    DependencyGraph<uint32_t> graph;
+    graph.add(1);
+    graph.add(2);
+    graph.add(3);
+    graph.add_dependency(1, 2);
+    graph.add_dependency(2, 3);
+    graph.add_dependency(3, 1);
+
+    uint32_t count = 42;
+    ASSERT_EQ(nullptr, graph.resolve(count));
+    ASSERT_EQ(0, count);
+
+    graph.remove_dependency(3, 1);
+    ASSERT_NE(nullptr, graph.resolve(count));
+    ASSERT_EQ(3, count);
+}
+
+TEST(DependencyGraphTest, TestDependsOn)
+{
+    DependencyGraph<uint32_t> graph;
+    graph.add(1);
+    graph.add(2);
+    graph.add(3);
+    graph.add_dependency(1, 2);
+    graph.add_dependency(2, 3);
+
+    ASSERT_TRUE(graph.depends_on(1, 3));
+    ASSERT_TRUE(graph.depends_on(1, 2));
+    ASSERT_FALSE(graph.depends_on(3, 1));
+    ASSERT_FALSE(graph.depends_on(2, 1));
+}
+
+TEST(DependencyGraphTest, TestRemovedNodeIsNotResolved)
+{
+    DependencyGraph<uint32_t> graph;
+    graph.add(1);
+    graph.add(2);
+    graph.add_dependency(1, 2);
+    graph.remove(2);
+
+    uint32_t count;
+    unique_ptr<uint32_t[]> order = graph.resolve(count);
+    ASSERT_NE(nullptr, order);
+    ASSERT_EQ(1, count);
+    ASSERT_EQ(1, order[0]);
+}
@@ -0,0 +1,80 @@
+#include <soundstone/MpscQueue.hpp>
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace soundstone;
+using namespace std;
+
+TEST(MpscQueueTests, TestCapacityIsRoundedToPowerOfTwo) {
+    MpscQueue<uint32_t> queue(5);
+    ASSERT_EQ(queue.capacity(), 8);
+}
+
+TEST(MpscQueueTests, TestPopIsFirstInFirstOut) {
+    MpscQueue<uint32_t> queue(4);
+    uint32_t value;
+    ASSERT_FALSE(queue.pop(value));
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 2);
+    ASSERT_FALSE(queue.pop(value));
+}
+
+TEST(MpscQueueTests, TestPushToFullQueueFails) {
+    MpscQueue<uint32_t> queue(2);
+    uint32_t value;
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    ASSERT_FALSE(queue.push(3));
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(queue.push(4));
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 2);
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 4);
+}
+
+TEST(MpscQueueTests, TestConcurrentProducersKeepTheirOrder) {
+    const uint32_t producer_count = 4;
+    const uint32_t count_per_producer = 20000;
+    MpscQueue<uint32_t> queue(64);
+
+    vector<thread> producers;
+    for (uint32_t producer = 0; producer < producer_count; ++producer) {
+        producers.emplace_back([&queue, producer, count_per_producer]{
+            for (uint32_t i = 0; i < count_per_producer; ++i) {
+                while (!queue.push(producer * count_per_producer + i)) {
+                    this_thread::yield();
+                }
+            }
+        });
+    }
+
+    vector<uint32_t> next(producer_count, 0);
+    bool is_in_order = true;
+    uint32_t popped_count = 0;
+    while (popped_count < producer_count * count_per_producer) {
+        uint32_t value;
+        if (!queue.pop(value)) {
+            this_thread::yield();
+            continue;
+        }
+        uint32_t producer = value / count_per_producer;
+        is_in_order = is_in_order && value % count_per_producer == next[producer];
+        ++next[producer];
+        ++popped_count;
+    }
+
+    for (thread &producer : producers) {
+        producer.join();
+    }
+    ASSERT_TRUE(is_in_order);
+    uint32_t value;
+    ASSERT_FALSE(queue.pop(value));
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <soundstone/OfflineDriver.hpp>
+#include <soundstone/FileOutputModule.hpp>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "util/ChannelSampler.hpp"
+
+using namespace soundstone;
+using namespace soundstone_test;
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+    vector<float> read_floats(const string &path) {
+        ifstream file(path, ios::binary);
+        vector<char> bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        vector<float> floats(bytes.size() / sizeof(float));
+        memcpy(floats.data(), bytes.data(), floats.size() * sizeof(float));
+        return floats;
+    }
+}
+
+TEST(OfflineDriverTests, TestRendersTheRequestedFramesToAFile) {
+    string path = testing::TempDir() + "soundstone_offline.raw";
+    AudioFileWriter writer;
+    ASSERT_TRUE(writer.open(path, AudioFileWriter::Format::RAW, 2, 48000));
+
+    AudioProcessor processor;
+    FileOutputModule output(&writer);
+    ChannelSampler source(2, 1, 1.0f);
+    processor.add_module(&output);
+    processor.add_module(&source);
+    processor.route(&source).to(&output);
+
+    OfflineDriver driver(&processor, 48000);
+    OfflineDriver::Report report = driver.render(1000);
+    ASSERT_EQ(report.frame_count, 1000);
+    ASSERT_GT(report.realtime_factor(), 0.0);
+    ASSERT_TRUE(writer.close());
+
+    vector<float> samples = read_floats(path);
+    ASSERT_EQ(samples.size(), 2000);
+    for (size_t i = 0; i < samples.size(); i += 2) {
+        ASSERT_EQ(samples[i], 1.0f);
+        ASSERT_EQ(samples[i + 1], 2.0f);
+    }
+}
+
+TEST(OfflineDriverTests, TestRenderForConvertsTheDurationToFrames) {
+    AudioProcessor processor;
+    OfflineDriver driver(&processor, 44100);
+
+    ASSERT_EQ(driver.render_for(milliseconds(500)).frame_count, 22050);
+    ASSERT_EQ(driver.render_for(seconds(3)).frame_count, 132300);
+    ASSERT_EQ(driver.render_for(nanoseconds(0)).frame_count, 0);
+}
+
+TEST(OfflineDriverTests, TestRealtimeFactorComparesAudioToElapsedTime) {
+    OfflineDriver::Report report;
+    report.frame_count = 96000;
+    report.sample_rate = 48000;
+    report.elapsed = milliseconds(500);
+    ASSERT_DOUBLE_EQ(report.realtime_factor(), 4.0);
+}
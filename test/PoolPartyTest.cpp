@@ -2,14 +2,22 @@
 
 #include <gtest/gtest.h>
 #include <chrono>
+#include <mutex>
+#include <tuple>
+#include <atomic>
+#include <thread>
 
 using namespace soundstone;
 using namespace testing;
 using namespace std;
 using namespace std::chrono;
 
-class PoolPartyTest : public TestWithParam<uint32_t> {
-
+class PoolPartyTest : public TestWithParam<tuple<uint32_t, PoolParty::Scheduler>> {
+protected:
+    void setup_party(PoolParty &party) {
+        party.set_scheduler(get<1>(GetParam()));
+        party.setup(get<0>(GetParam()));
+    }
 };
 
 
@@ -21,7 +29,7 @@ TEST(PoolPartyTest, TestConstructDestruct)
 TEST_P(PoolPartyTest, TestWorkWithZeroActions)
 {
     PoolParty party;
-    party.setup(GetParam());
+    setup_party(party);
     party.work();
 }
 
@@ -30,7 +38,7 @@ TEST_P(PoolPartyTest, TestWorkWithOneAction)
     uint32_t count_a = 0;
 
     PoolParty party;
-    party.setup(GetParam());
+    setup_party(party);
     party.add_work([&]{ count_a++; });
     party.work();
 
@@ -43,7 +51,7 @@ TEST_P(PoolPartyTest, TestWorkWithManyActionsWorks)
     count_a = count_b = count_c =count_d = count_e = count_f = 0;
 
     PoolParty party;
-    party.setup(GetParam());
+    setup_party(party);
     party.add_work([&]{ count_a++; });
     party.add_work([&]{ count_b++; });
     party.add_work([&]{ count_c++; });
@@ -65,7 +73,7 @@ TEST_P(PoolPartyTest, TestDependenciesAreRespected)
     vector<uint32_t> orders;
 
     PoolParty party;
-    party.setup(GetParam());
+    setup_party(party);
     uint32_t dependency = 1;
     party.add_work([&]{ orders.push_back(0); }, &dependency, 1);
     party.add_work([&]{ this_thread::sleep_for(milliseconds(500)); orders.push_back(1); });
@@ -76,8 +84,178 @@ TEST_P(PoolPartyTest, TestDependenciesAreRespected)
     ASSERT_EQ(orders[1], 0);
 }
 
+TEST_P(PoolPartyTest, TestWorkIsKeptBetweenCalls)
+{
+    uint32_t count_a = 0;
+
+    PoolParty party;
+    setup_party(party);
+    party.add_work([&]{ count_a++; });
+    party.work();
+    party.work();
+
+    ASSERT_EQ(count_a, 2);
+}
+
+TEST_P(PoolPartyTest, TestClearWork)
+{
+    uint32_t count_a = 0, count_b = 0;
+
+    PoolParty party;
+    setup_party(party);
+    party.add_work([&]{ count_a++; });
+    party.work();
+    party.clear_work();
+    party.add_work([&]{ count_b++; });
+    party.work();
+
+    ASSERT_EQ(count_a, 1);
+    ASSERT_EQ(count_b, 1);
+}
+
+TEST_P(PoolPartyTest, TestChainAndFanInDependenciesAreRespected)
+{
+    // 0 -> 1 -> ... -> 31, with all of them feeding into 32.
+    const uint32_t chain_length = 32;
+    vector<uint32_t> orders;
+    mutex orders_mutex;
+    uint32_t chain_dependencies[chain_length];
+    uint32_t fan_in_dependencies[chain_length];
+
+    PoolParty party;
+    setup_party(party);
+    for (uint32_t i = 0; i < chain_length; ++i) {
+        chain_dependencies[i] = i - 1;
+        fan_in_dependencies[i] = i;
+        party.add_work([&, i]{ lock_guard<mutex> lock(orders_mutex); orders.push_back(i); }, &chain_dependencies[i], i > 0);
+    }
+    party.add_work([&]{ lock_guard<mutex> lock(orders_mutex); orders.push_back(chain_length); },
+        fan_in_dependencies, chain_length);
+
+    for (uint32_t run = 0; run < 4; ++run) {
+        orders.clear();
+        party.work();
+
+        ASSERT_EQ(orders.size(), chain_length + 1);
+        for (uint32_t i = 0; i <= chain_length; ++i) {
+            ASSERT_EQ(orders[i], i);
+        }
+    }
+}
+
+TEST(PoolPartyTest, TestReadyWorkIsTakenInPriorityOrder)
+{
+    // Without workers the calling thread runs everything, so the order is fully decided by the scheduler. Work 0, 1
+    // and 2 are ready from the start, 3, 4 and 5 all become ready when 1 finishes.
+    uint32_t dependencies[] = {1};
+    uint64_t priorities[] = {1, 9, 5, 2, 7, 3};
+    const uint32_t work_count = 6;
+
+    // The shared ready list always has the highest priority work taken next. A work stealing worker takes what it
+    // made ready itself first, highest priority first.
+    const PoolParty::Scheduler schedulers[] = {PoolParty::Scheduler::SHARED, PoolParty::Scheduler::WORK_STEALING};
+    const vector<uint32_t> expected_orders[] = {{1, 4, 2, 5, 3, 0}, {1, 4, 5, 3, 2, 0}};
+
+    for (uint32_t s = 0; s < 2; ++s) {
+        vector<uint32_t> orders;
+        PoolParty party;
+        party.set_scheduler(schedulers[s]);
+        party.setup(0);
+        for (uint32_t i = 0; i < work_count; ++i) {
+            party.add_work([&, i]{ orders.push_back(i); }, dependencies, i < 3 ? 0 : 1, priorities[i]);
+        }
+
+        party.work();
+
+        ASSERT_EQ(orders, expected_orders[s]);
+    }
+}
+
+TEST(PoolPartyTest, TestWorkMadeReadyLaterJumpsAheadOfLowerPriorityBands)
+{
+    // Many more priorities than bands. The head of a chain and the work after it outrank 32 pieces of work which are
+    // ready from the start, so the chain runs first even though its second piece only becomes ready later.
+    const uint32_t leaf_count = 32;
+    uint32_t head = leaf_count;
+    vector<uint32_t> orders;
+
+    PoolParty party;
+    party.setup(0);
+    for (uint32_t i = 0; i < leaf_count; ++i) {
+        party.add_work([&, i]{ orders.push_back(i); }, nullptr, 0, i);
+    }
+    party.add_work([&]{ orders.push_back(head); }, nullptr, 0, 1000);
+    party.add_work([&]{ orders.push_back(head + 1); }, &head, 1, 999);
+
+    party.work();
+
+    ASSERT_EQ(orders.size(), leaf_count + 2);
+    ASSERT_EQ(orders[0], head);
+    ASSERT_EQ(orders[1], head + 1);
+    for (uint32_t i = 0; i < leaf_count; ++i) {
+        ASSERT_EQ(orders[i + 2], leaf_count - 1 - i);
+    }
+}
+
+TEST_P(PoolPartyTest, TestWorkWithWorkersThatSleepRightAway)
+{
+    // Work 1 and 2 depend on 0, 3 depends on both.
+    atomic<uint32_t> count(0);
+    uint32_t dependencies[] = {0, 1, 2};
+
+    PoolParty party;
+    party.set_scheduler(get<1>(GetParam()));
+    party.setup(get<0>(GetParam()), PoolParty::WaitPolicy(nanoseconds(0), nanoseconds(0)));
+    party.add_work([&]{ this_thread::sleep_for(milliseconds(1)); ++count; });
+    party.add_work([&]{ ++count; }, &dependencies[0], 1);
+    party.add_work([&]{ ++count; }, &dependencies[0], 1);
+    party.add_work([&]{ ++count; }, &dependencies[1], 2);
+
+    for (uint32_t run = 0; run < 8; ++run) {
+        party.work();
+        this_thread::sleep_for(milliseconds(1));
+    }
+
+    ASSERT_EQ(count, 32);
+}
+
+
+TEST_P(PoolPartyTest, TestSwitchingBetweenWorkSetsPreparedOnAnotherThread)
+{
+    // Set A is a chain of two, set B is a fan in of three into one.
+    uint32_t a_dependencies[] = {0};
+    uint32_t b_dependencies[] = {0, 1, 2};
+    atomic<uint32_t> a_count(0), b_count(0);
+    PoolParty::WorkSet set_a, set_b;
+
+    PoolParty party;
+    setup_party(party);
+
+    thread preparer([&]{
+        set_a.add_work([&]{ ++a_count; });
+        set_a.add_work([&]{ ++a_count; }, a_dependencies, 1);
+        set_a.prepare(party.worker_count(), party.scheduler());
+
+        for (uint32_t i = 0; i < 3; ++i) {
+            set_b.add_work([&]{ ++b_count; });
+        }
+        set_b.add_work([&]{ ++b_count; }, b_dependencies, 3);
+        set_b.prepare(party.worker_count(), party.scheduler());
+    });
+    preparer.join();
+
+    for (uint32_t run = 0; run < 4; ++run) {
+        party.work(set_a);
+        party.work(set_b);
+        party.work(set_b);
+    }
+
+    ASSERT_EQ(a_count, 8);
+    ASSERT_EQ(b_count, 32);
+}
+
 
 INSTANTIATE_TEST_SUITE_P(
     PoolPartyTestImpl,
     PoolPartyTest,
-    ::testing::Values(1, 2, 3, 4));
+    Combine(Values(0, 1, 2, 3, 4), Values(PoolParty::Scheduler::SHARED, PoolParty::Scheduler::WORK_STEALING)));
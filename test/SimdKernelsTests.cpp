@@ -0,0 +1,203 @@
+#include <soundstone/simd/Kernels.hpp>
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace soundstone;
+using namespace soundstone::simd;
+using namespace testing;
+using namespace std;
+
+namespace {
+    // Lengths covering empty buffers, buffers shorter than any vector, and every remainder of the widest vector.
+    const uint32_t COUNTS[] = {0, 1, 3, 8, 15, 16, 17, 31, 33, 64, 100, 257};
+
+    vector<float> random_samples(uint32_t count, uint32_t seed) {
+        mt19937 generator(seed);
+        // Go past full scale so clamping and saturation are exercised.
+        uniform_real_distribution<float> distribution(-1.5f, 1.5f);
+        vector<float> samples(count);
+        for (float &sample : samples) {
+            sample = distribution(generator);
+        }
+        return samples;
+    }
+}
+
+class SimdKernelsTests : public TestWithParam<InstructionSet> {
+protected:
+    const KernelTable *_scalar = nullptr;
+    const KernelTable *_kernels = nullptr;
+
+    void SetUp() override {
+        _scalar = kernel_table(InstructionSet::SCALAR);
+        _kernels = kernel_table(GetParam());
+        if (_kernels == nullptr) {
+            GTEST_SKIP() << "Instruction set not supported";
+        }
+    }
+};
+
+TEST(SimdKernelsTests, TestDetectedInstructionSetIsUsedByDefault)
+{
+    ASSERT_NE(kernel_table(detect_instruction_set()), nullptr);
+    ASSERT_NE(kernel_table(InstructionSet::SCALAR), nullptr);
+    ASSERT_EQ(instruction_set(), detect_instruction_set());
+}
+
+TEST(SimdKernelsTests, TestInstructionSetCanBeChanged)
+{
+    ASSERT_TRUE(set_instruction_set(InstructionSet::SCALAR));
+    ASSERT_EQ(instruction_set(), InstructionSet::SCALAR);
+    ASSERT_TRUE(set_instruction_set(detect_instruction_set()));
+    ASSERT_EQ(instruction_set(), detect_instruction_set());
+}
+
+TEST(SimdKernelsTests, TestIntegersSurviveRoundTrips)
+{
+    vector<int16_t> int16_values = {-32768, -1, 0, 1, 32767};
+    vector<float> floats(int16_values.size());
+    vector<int16_t> int16_result(int16_values.size());
+    int16_to_float(int16_values.data(), floats.data(), floats.size());
+    ASSERT_EQ(floats[0], -1.0f);
+    float_to_int16(floats.data(), int16_result.data(), floats.size());
+    ASSERT_EQ(int16_result, int16_values);
+
+    vector<int32_t> int24_values = {-8388608, -1, 0, 1, 8388607};
+    vector<int32_t> int24_result(int24_values.size());
+    int24_to_float(int24_values.data(), floats.data(), floats.size());
+    float_to_int24(floats.data(), int24_result.data(), floats.size());
+    ASSERT_EQ(int24_result, int24_values);
+}
+
+TEST(SimdKernelsTests, TestFullScaleSaturates)
+{
+    vector<float> floats = {-2.0f, 1.0f, 2.0f};
+    vector<int16_t> int16_result(floats.size());
+    float_to_int16(floats.data(), int16_result.data(), floats.size());
+    vector<int16_t> expected = {-32768, 32767, 32767};
+    ASSERT_EQ(int16_result, expected);
+}
+
+TEST(SimdKernelsTests, TestGainRampsLinearly)
+{
+    vector<float> ones(4, 1.0f);
+    vector<float> output(4);
+    gain_ramp(ones.data(), 0.0f, 1.0f, output.data(), 4);
+    vector<float> expected = {0.0f, 0.25f, 0.5f, 0.75f};
+    ASSERT_EQ(output, expected);
+}
+
+TEST(SimdKernelsTests, TestStereoInterleaves)
+{
+    vector<float> planar = {1, 2, 3, 4, 5, 6};
+    vector<float> interleaved(6);
+    interleave(planar.data(), 3, 2, 3, interleaved.data());
+    vector<float> expected = {1, 4, 2, 5, 3, 6};
+    ASSERT_EQ(interleaved, expected);
+
+    vector<float> result(6);
+    deinterleave(interleaved.data(), 2, 3, result.data(), 3);
+    ASSERT_EQ(result, planar);
+}
+
+TEST_P(SimdKernelsTests, TestSumMatchesScalar)
+{
+    for (uint32_t count : COUNTS) {
+        vector<vector<float>> inputs = {random_samples(count, 1), random_samples(count, 2), random_samples(count, 3)};
+        const float *input_pointers[] = {inputs[0].data(), inputs[1].data(), inputs[2].data()};
+        for (uint32_t input_count = 0; input_count <= 3; ++input_count) {
+            vector<float> expected(count, 1.0f), output(count, 1.0f);
+            _scalar->sum(input_pointers, input_count, expected.data(), count);
+            _kernels->sum(input_pointers, input_count, output.data(), count);
+            ASSERT_EQ(output, expected) << "count " << count << ", inputs " << input_count;
+        }
+    }
+}
+
+TEST_P(SimdKernelsTests, TestScaledAddMatchesScalar)
+{
+    for (uint32_t count : COUNTS) {
+        vector<float> input = random_samples(count, 4);
+        vector<float> expected = random_samples(count, 5);
+        vector<float> output = expected;
+        _scalar->scaled_add(input.data(), 0.3f, expected.data(), count);
+        _kernels->scaled_add(input.data(), 0.3f, output.data(), count);
+        ASSERT_EQ(output, expected) << "count " << count;
+    }
+}
+
+TEST_P(SimdKernelsTests, TestGainRampMatchesScalar)
+{
+    for (uint32_t count : COUNTS) {
+        vector<float> input = random_samples(count, 6);
+        vector<float> expected(count), output(count);
+        _scalar->gain_ramp(input.data(), 0.9f, 0.1f, expected.data(), count);
+        _kernels->gain_ramp(input.data(), 0.9f, 0.1f, output.data(), count);
+        ASSERT_EQ(output, expected) << "count " << count;
+    }
+}
+
+TEST_P(SimdKernelsTests, TestClampMatchesScalar)
+{
+    for (uint32_t count : COUNTS) {
+        vector<float> input = random_samples(count, 7);
+        vector<float> expected(count), output(count);
+        _scalar->clamp(input.data(), -1.0f, 1.0f, expected.data(), count);
+        _kernels->clamp(input.data(), -1.0f, 1.0f, output.data(), count);
+        ASSERT_EQ(output, expected) << "count " << count;
+    }
+}
+
+TEST_P(SimdKernelsTests, TestConversionsMatchScalar)
+{
+    for (uint32_t count : COUNTS) {
+        vector<float> input = random_samples(count, 8);
+
+        vector<int16_t> expected_int16(count), output_int16(count);
+        _scalar->float_to_int16(input.data(), expected_int16.data(), count);
+        _kernels->float_to_int16(input.data(), output_int16.data(), count);
+        ASSERT_EQ(output_int16, expected_int16) << "count " << count;
+
+        vector<float> expected_floats(count), output_floats(count);
+        _scalar->int16_to_float(expected_int16.data(), expected_floats.data(), count);
+        _kernels->int16_to_float(expected_int16.data(), output_floats.data(), count);
+        ASSERT_EQ(output_floats, expected_floats) << "count " << count;
+
+        vector<int32_t> expected_int24(count), output_int24(count);
+        _scalar->float_to_int24(input.data(), expected_int24.data(), count);
+        _kernels->float_to_int24(input.data(), output_int24.data(), count);
+        ASSERT_EQ(output_int24, expected_int24) << "count " << count;
+
+        _scalar->int24_to_float(expected_int24.data(), expected_floats.data(), count);
+        _kernels->int24_to_float(expected_int24.data(), output_floats.data(), count);
+        ASSERT_EQ(output_floats, expected_floats) << "count " << count;
+    }
+}
+
+TEST_P(SimdKernelsTests, TestInterleavingMatchesScalar)
+{
+    for (uint32_t count : COUNTS) {
+        for (uint32_t channel_count = 1; channel_count <= 3; ++channel_count) {
+            // Channels are spaced further apart than the frame count, like the last block of an update.
+            uint32_t stride = count + 5;
+            vector<float> planar = random_samples(stride * channel_count, 9);
+
+            vector<float> expected(count * channel_count), output(count * channel_count);
+            _scalar->interleave(planar.data(), stride, channel_count, count, expected.data());
+            _kernels->interleave(planar.data(), stride, channel_count, count, output.data());
+            ASSERT_EQ(output, expected) << "count " << count << ", channels " << channel_count;
+
+            vector<float> expected_planar(stride * channel_count), output_planar(stride * channel_count);
+            _scalar->deinterleave(expected.data(), channel_count, count, expected_planar.data(), stride);
+            _kernels->deinterleave(expected.data(), channel_count, count, output_planar.data(), stride);
+            ASSERT_EQ(output_planar, expected_planar) << "count " << count << ", channels " << channel_count;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SimdKernelsTestsImpl,
+    SimdKernelsTests,
+    ::testing::Values(InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512));
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <soundstone/SpscRingBuffer.hpp>
+#include <array>
+#include <thread>
+#include <vector>
+
+using namespace soundstone;
+using namespace std;
+
+TEST(SpscRingBufferTests, TestCapacityIsRoundedToPowerOfTwo) {
+    SpscRingBuffer<float> ringbuffer(5);
+    ASSERT_EQ(ringbuffer.capacity(), 8);
+    ringbuffer.reserve(16);
+    ASSERT_EQ(ringbuffer.capacity(), 16);
+}
+
+TEST(SpscRingBufferTests, TestProduceIsLimitedByCapacity) {
+    SpscRingBuffer<float> ringbuffer(4);
+    array<float, 6> values = {{1, 2, 3, 4, 5, 6}};
+    ASSERT_EQ(ringbuffer.produce(values.data(), 3), 3);
+    ASSERT_EQ(ringbuffer.produce(values.data(), 6), 1);
+    ASSERT_EQ(ringbuffer.size(), 4);
+    ASSERT_EQ(ringbuffer.produce(values.data(), 1), 0);
+}
+
+TEST(SpscRingBufferTests, TestConsumeIsLimitedBySize) {
+    SpscRingBuffer<float> ringbuffer(4);
+    array<float, 2> in_values = {{1, 2}};
+    array<float, 4> out_values = {{0, 0, 0, 0}};
+    array<float, 4> expected = {{1, 2, 0, 0}};
+    ringbuffer.produce(in_values.data(), 2);
+    ASSERT_EQ(ringbuffer.consume(out_values.data(), 4), 2);
+    ASSERT_EQ(out_values, expected);
+    ASSERT_EQ(ringbuffer.size(), 0);
+}
+
+TEST(SpscRingBufferTests, TestProducePastBoundary) {
+    SpscRingBuffer<float> ringbuffer(8);
+    array<float, 8> in_values = {{1, 2, 3, 4, 5, 6, 7, 8}};
+    array<float, 6> out_values1;
+    array<float, 8> out_values2;
+    array<float, 6> expected_out1 = {{1, 2, 3, 4, 5, 6}};
+    array<float, 8> expected_out2 = {{7, 8, 1, 2, 3, 4, 5, 6}};
+    ringbuffer.produce(in_values.data(), 8);
+    ringbuffer.consume(out_values1.data(), 6);
+    ringbuffer.produce(in_values.data(), 6);
+    ASSERT_EQ(ringbuffer.consume(out_values2.data(), 8), 8);
+    ASSERT_EQ(out_values1, expected_out1);
+    ASSERT_EQ(out_values2, expected_out2);
+}
+
+TEST(SpscRingBufferTests, TestConcurrentProducerAndConsumer) {
+    const size_t count = 100000;
+    SpscRingBuffer<float> ringbuffer(64);
+
+    thread producer([&]{
+        array<float, 37> chunk;
+        size_t next = 0;
+        while (next < count) {
+            size_t chunk_count = min(chunk.size(), count - next);
+            for (size_t i = 0; i < chunk_count; ++i) {
+                chunk[i] = static_cast<float>(next + i);
+            }
+            size_t produced = 0;
+            while (produced < chunk_count) {
+                size_t just_produced = ringbuffer.produce(chunk.data() + produced, chunk_count - produced);
+                if (just_produced == 0) {
+                    this_thread::yield();
+                }
+                produced += just_produced;
+            }
+            next += chunk_count;
+        }
+    });
+
+    array<float, 23> chunk;
+    size_t expected = 0;
+    bool is_in_order = true;
+    while (expected < count) {
+        size_t consumed = ringbuffer.consume(chunk.data(), chunk.size());
+        if (consumed == 0) {
+            this_thread::yield();
+        }
+        for (size_t i = 0; i < consumed; ++i) {
+            is_in_order = is_in_order && chunk[i] == static_cast<float>(expected + i);
+        }
+        expected += consumed;
+    }
+    producer.join();
+
+    ASSERT_TRUE(is_in_order);
+    ASSERT_EQ(ringbuffer.size(), 0);
+}
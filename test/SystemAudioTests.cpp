@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include <soundstone/SystemAudio.hpp>
+#include <soundstone/NullAudioBackend.hpp>
+#include <soundstone/SystemOutputModule.hpp>
+#include <soundstone/AudioProcessor.hpp>
+#include <soundstone/CallbackDriver.hpp>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+#include "util/ChannelSampler.hpp"
+
+using namespace soundstone;
+using namespace soundstone_test;
+using namespace std;
+
+namespace {
+    const uint32_t PERIOD_FRAMES = 64;
+
+    class CountingListener : public SystemAudio::LowWaterListener {
+    public:
+        uint32_t count = 0;
+
+        void on_low_water() override {
+            ++count;
+        }
+    };
+
+    class ConstantRenderer : public SystemAudio::Renderer {
+    public:
+        void render(float *frames, uint32_t frame_count) override {
+            fill(frames, frames + frame_count * 2, 0.5f);
+        }
+    };
+
+    vector<float> make_frames(uint32_t frame_count, uint32_t channel_count) {
+        vector<float> frames(frame_count * channel_count);
+        for (size_t i = 0; i < frames.size(); ++i) {
+            frames[i] = static_cast<float>(i);
+        }
+        return frames;
+    }
+}
+
+class SystemAudioTests : public ::testing::Test {
+protected:
+    NullAudioBackend *backend = new NullAudioBackend(48000, PERIOD_FRAMES, NullAudioBackend::Clock::MANUAL);
+    SystemAudio system {unique_ptr<SystemAudioBackend>(backend), 2};
+
+    void SetUp() override {
+        backend->set_loopback_enabled(true);
+    }
+};
+
+TEST_F(SystemAudioTests, TestBackendSetsTheStreamParameters) {
+    ASSERT_TRUE(system.is_ok());
+    ASSERT_TRUE(system.is_stream_playing());
+    ASSERT_EQ(system.sample_rate(), 48000);
+    ASSERT_EQ(system.latency(), PERIOD_FRAMES);
+    ASSERT_EQ(system.channel_count(), 2);
+}
+
+TEST_F(SystemAudioTests, TestQueuedFramesArePlayedOnePeriodAtATime) {
+    vector<float> frames = make_frames(PERIOD_FRAMES * 3, 2);
+    ASSERT_EQ(system.update(frames.data(), PERIOD_FRAMES * 3), PERIOD_FRAMES * 3);
+
+    backend->advance(2);
+    ASSERT_EQ(system.samples_buffered(), PERIOD_FRAMES);
+    ASSERT_EQ(backend->frames_played(), PERIOD_FRAMES * 2);
+    ASSERT_EQ(backend->underflow_count(), 0);
+
+    vector<float> loopback = backend->take_loopback();
+    ASSERT_EQ(loopback, vector<float>(frames.begin(), frames.begin() + PERIOD_FRAMES * 2 * 2));
+}
+
+TEST_F(SystemAudioTests, TestRunningOutOfFramesDrainsUntilMoreAreQueued) {
+    uint32_t drained_count = 0;
+    system.set_drained_callback([&] { ++drained_count; });
+
+    vector<float> frames = make_frames(PERIOD_FRAMES / 2, 2);
+    system.update(frames.data(), PERIOD_FRAMES / 2);
+    backend->advance(3);
+    ASSERT_TRUE(system.is_stream_drained());
+    ASSERT_EQ(drained_count, 1);
+    ASSERT_EQ(backend->underflow_count(), 1);
+    ASSERT_EQ(backend->frames_played(), PERIOD_FRAMES / 2);
+
+    // The rest of the underflowing period is silence, and nothing is played while drained.
+    vector<float> loopback = backend->take_loopback();
+    ASSERT_EQ(loopback.size(), PERIOD_FRAMES * 2);
+    ASSERT_EQ(loopback.back(), 0.0f);
+
+    system.update(frames.data(), PERIOD_FRAMES / 2);
+    ASSERT_TRUE(system.is_stream_playing());
+    backend->advance(1);
+    ASSERT_EQ(backend->frames_played(), PERIOD_FRAMES);
+    ASSERT_EQ(backend->underflow_count(), 2);
+}
+
+TEST_F(SystemAudioTests, TestLowWaterListenerIsToldWhenTheMarkIsCrossed) {
+    CountingListener listener;
+    system.set_low_water_listener(&listener, PERIOD_FRAMES);
+
+    vector<float> frames = make_frames(PERIOD_FRAMES * 4, 2);
+    system.update(frames.data(), PERIOD_FRAMES * 3);
+    backend->advance(1);
+    ASSERT_EQ(listener.count, 0);
+    backend->advance(1);
+    ASSERT_EQ(listener.count, 1);
+
+    // Staying under the mark isn't reported again, but crossing it again is.
+    backend->advance(1);
+    ASSERT_EQ(listener.count, 1);
+    system.update(frames.data(), PERIOD_FRAMES * 2);
+    backend->advance(1);
+    ASSERT_EQ(listener.count, 2);
+
+    system.set_low_water_listener(nullptr, 0);
+}
+
+TEST_F(SystemAudioTests, TestRendererFillsEveryPeriod) {
+    ConstantRenderer renderer;
+    system.set_renderer(&renderer);
+    backend->advance(4);
+    system.set_renderer(nullptr);
+
+    ASSERT_EQ(backend->underflow_count(), 0);
+    ASSERT_EQ(backend->take_loopback(), vector<float>(PERIOD_FRAMES * 4 * 2, 0.5f));
+}
+
+TEST_F(SystemAudioTests, TestSystemOutputModuleQueuesInterleavedFrames) {
+    AudioProcessor processor;
+    SystemOutputModule output(&system);
+    ChannelSampler source(2, 1, 1.0f);
+    processor.add_module(&output);
+    processor.add_module(&source);
+    processor.route(&source).to(&output);
+    processor.wait_for_changes();
+
+    processor.update(PERIOD_FRAMES);
+    backend->advance(1);
+
+    vector<float> loopback = backend->take_loopback();
+    ASSERT_EQ(loopback.size(), PERIOD_FRAMES * 2);
+    for (size_t i = 0; i < loopback.size(); i += 2) {
+        ASSERT_EQ(loopback[i], 1.0f);
+        ASSERT_EQ(loopback[i + 1], 2.0f);
+    }
+}
+
+TEST_F(SystemAudioTests, TestCallbackDriverRendersEveryPeriodOnTheDeviceThread) {
+    AudioProcessor processor;
+    processor.set_thread_count(1);
+    SystemOutputModule output(&system);
+    ChannelSampler source(2, 1, 1.0f);
+    processor.add_module(&output);
+    processor.add_module(&source);
+    processor.route(&source).to(&output);
+    processor.wait_for_changes();
+
+    CallbackDriver driver(&processor, &system, &output);
+    driver.start();
+    backend->advance(3);
+    driver.finish();
+
+    ASSERT_EQ(backend->underflow_count(), 0);
+    vector<float> loopback = backend->take_loopback();
+    ASSERT_EQ(loopback.size(), PERIOD_FRAMES * 3 * 2);
+    for (size_t i = 0; i < loopback.size(); i += 2) {
+        ASSERT_EQ(loopback[i], 1.0f);
+        ASSERT_EQ(loopback[i + 1], 2.0f);
+    }
+}
+
+TEST_F(SystemAudioTests, TestTelemetryCountsUnderflowsAndQueueDepth) {
+    vector<float> frames = make_frames(100, 2);
+    system.update(frames.data(), 100);
+    backend->advance(2);
+
+    SystemAudio::Telemetry telemetry = system.telemetry();
+    ASSERT_EQ(telemetry.callback_count, 2);
+    ASSERT_EQ(telemetry.underflow_count, 1);
+    ASSERT_EQ(telemetry.short_fill_frames, PERIOD_FRAMES * 2 - 100);
+    ASSERT_EQ(telemetry.min_buffered_frames, 100 - PERIOD_FRAMES);
+    ASSERT_EQ(telemetry.max_buffered_frames, 100);
+
+    // 36 frames land in [32, 64) and 100 in [64, 128).
+    ASSERT_EQ(telemetry.buffered_frames_histogram[6], 1);
+    ASSERT_EQ(telemetry.buffered_frames_histogram[7], 1);
+
+    ASSERT_EQ(telemetry.callback_duration.count, 2);
+    ASSERT_EQ(telemetry.period_jitter.count, 1);
+}
+
+TEST(NullAudioBackendTests, TestRealtimeClockPullsPeriodsOnItsOwn) {
+    NullAudioBackend *backend = new NullAudioBackend(48000, 48, NullAudioBackend::Clock::REALTIME);
+    SystemAudio system(unique_ptr<SystemAudioBackend>(backend), 1);
+    ASSERT_TRUE(system.is_ok());
+
+    vector<float> frames(480, 1.0f);
+    system.update(frames.data(), frames.size());
+
+    // Frames are only counted as played once the period they're in has been handed over, which can be after they've
+    // left the queue.
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::seconds(5);
+    while (backend->frames_played() < 480 && chrono::steady_clock::now() < deadline) {
+        this_thread::yield();
+    }
+    ASSERT_EQ(backend->frames_played(), 480);
+    ASSERT_EQ(system.samples_buffered(), 0);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <soundstone/ThreadConfig.hpp>
+#include <soundstone/PoolParty.hpp>
+#include <thread>
+
+using namespace soundstone;
+using namespace std;
+
+namespace {
+    // Applied on a thread of its own, so the test runner's thread is left alone.
+    ThreadConfig::Report apply_on_new_thread(const ThreadConfig &config) {
+        ThreadConfig::Report report;
+        thread([&] { report = config.apply(); }).join();
+        return report;
+    }
+}
+
+TEST(ThreadConfigTests, TestNothingIsAppliedByDefault) {
+    ThreadConfig::Report report = apply_on_new_thread(ThreadConfig());
+    ASSERT_FALSE(report.priority);
+    ASSERT_FALSE(report.affinity);
+    ASSERT_FALSE(report.memory_locked);
+    ASSERT_FALSE(report.stack_prefaulted);
+    ASSERT_FALSE(report.denormals_flushed);
+}
+
+TEST(ThreadConfigTests, TestFlushedDenormalsReadAsZero) {
+    ThreadConfig config;
+    config.flush_denormals = true;
+
+    bool is_flushed = false;
+    float product = 1.0f;
+    thread([&] {
+        is_flushed = config.apply().denormals_flushed;
+        volatile float smallest_normal = 1.17549435e-38f;
+        product = smallest_normal * 0.5f;
+    }).join();
+
+    if (is_flushed) {
+        ASSERT_EQ(product, 0.0f);
+    }
+}
+
+TEST(ThreadConfigTests, TestStackIsPrefaulted) {
+    ThreadConfig config;
+    config.prefault_stack_bytes = 64 * 1024;
+
+#if defined(__unix__) || defined(__APPLE__)
+    ASSERT_TRUE(apply_on_new_thread(config).stack_prefaulted);
+#else
+    apply_on_new_thread(config);
+#endif
+}
+
+TEST(ThreadConfigTests, TestAffinityIsApplied) {
+    ThreadConfig config;
+    config.cpus = {0};
+
+#if defined(__linux__)
+    ASSERT_TRUE(apply_on_new_thread(config).affinity);
+#else
+    ASSERT_FALSE(apply_on_new_thread(config).affinity);
+#endif
+}
+
+TEST(ThreadConfigTests, TestCpusOutOfRangeAreNotApplied) {
+    ThreadConfig config;
+    config.cpus = {UINT32_MAX};
+    ASSERT_FALSE(apply_on_new_thread(config).affinity);
+}
+
+TEST(ThreadConfigTests, TestRealtimePriorityFailsGracefully) {
+    // Whether this is allowed depends on the privileges the tests run with, but either way the thread carries on.
+    ThreadConfig config;
+    config.policy = ThreadConfig::Policy::ROUND_ROBIN;
+    config.priority = 1;
+    apply_on_new_thread(config);
+}
+
+TEST(ThreadConfigTests, TestPoolPartyWorkersReportTheirConfig) {
+    ThreadConfig config;
+    config.prefault_stack_bytes = 16 * 1024;
+
+    PoolParty party;
+    party.setup(3, PoolParty::WaitPolicy(), config);
+    ASSERT_EQ(party.thread_config_reports().size(), 3);
+
+#if defined(__unix__) || defined(__APPLE__)
+    for (const ThreadConfig::Report &report : party.thread_config_reports()) {
+        ASSERT_TRUE(report.stack_prefaulted);
+        ASSERT_FALSE(report.priority);
+    }
+#endif
+
+    // The config is kept when the party is set up again without one.
+    party.setup(1, PoolParty::WaitPolicy());
+    ASSERT_EQ(party.thread_config_reports().size(), 1);
+}
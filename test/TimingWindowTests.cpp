@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <soundstone/TimingWindow.hpp>
+#include <atomic>
+#include <thread>
+
+using namespace soundstone;
+using namespace std;
+using namespace std::chrono;
+
+TEST(TimingWindowTests, TestEmptyWindowSummarizesToZero) {
+    TimingWindow window;
+    TimingWindow::Summary summary = window.summarize();
+    ASSERT_EQ(summary.count, 0);
+    ASSERT_EQ(summary.last.count(), 0);
+    ASSERT_EQ(summary.max.count(), 0);
+}
+
+TEST(TimingWindowTests, TestSummaryCoversThePartlyFilledWindow) {
+    TimingWindow window;
+    window.record(nanoseconds(10));
+    window.record(nanoseconds(30));
+    window.record(nanoseconds(20));
+
+    TimingWindow::Summary summary = window.summarize();
+    ASSERT_EQ(summary.count, 3);
+    ASSERT_EQ(summary.last.count(), 20);
+    ASSERT_EQ(summary.mean.count(), 20);
+    ASSERT_EQ(summary.max.count(), 30);
+    ASSERT_EQ(summary.p99.count(), 30);
+}
+
+TEST(TimingWindowTests, TestOldestRunsLeaveTheWindow) {
+    TimingWindow window;
+    window.record(microseconds(1000));
+    for (uint32_t i = 1; i <= TimingWindow::CAPACITY; ++i) {
+        window.record(nanoseconds(i));
+    }
+
+    TimingWindow::Summary summary = window.summarize();
+    ASSERT_EQ(summary.count, TimingWindow::CAPACITY + 1);
+    ASSERT_EQ(summary.last.count(), TimingWindow::CAPACITY);
+    ASSERT_EQ(summary.max.count(), TimingWindow::CAPACITY);
+    ASSERT_EQ(summary.mean.count(), (TimingWindow::CAPACITY + 1) / 2);
+    // The 99th percentile of 128 runs is the second slowest.
+    ASSERT_EQ(summary.p99.count(), TimingWindow::CAPACITY - 1);
+}
+
+TEST(TimingWindowTests, TestSummariesAreConsistentWhileRecording) {
+    TimingWindow window;
+    atomic<bool> is_done {false};
+
+    // Every record in the window is the same as the count at the time, so a torn read shows up as a mismatch.
+    thread writer([&] {
+        for (uint32_t i = 1; i <= 20000; ++i) {
+            window.record(nanoseconds(i));
+        }
+        is_done = true;
+    });
+
+    while (!is_done) {
+        TimingWindow::Summary summary = window.summarize();
+        if (summary.count > 0) {
+            ASSERT_EQ(summary.last.count(), static_cast<int64_t>(summary.count));
+            ASSERT_EQ(summary.max, summary.last);
+        }
+    }
+    writer.join();
+}
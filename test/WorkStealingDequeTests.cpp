@@ -0,0 +1,100 @@
+#include <soundstone/WorkStealingDeque.hpp>
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+using namespace soundstone;
+using namespace std;
+
+TEST(WorkStealingDequeTests, TestEmptyDeque) {
+    WorkStealingDeque deque;
+    deque.reserve(4);
+    ASSERT_EQ(deque.take(), WorkStealingDeque::EMPTY);
+    ASSERT_EQ(deque.steal(), WorkStealingDeque::EMPTY);
+}
+
+TEST(WorkStealingDequeTests, TestTakeIsLastInFirstOut) {
+    WorkStealingDeque deque;
+    deque.reserve(4);
+    deque.push(1);
+    deque.push(2);
+    deque.push(3);
+    ASSERT_EQ(deque.take(), 3);
+    ASSERT_EQ(deque.take(), 2);
+    ASSERT_EQ(deque.take(), 1);
+    ASSERT_EQ(deque.take(), WorkStealingDeque::EMPTY);
+}
+
+TEST(WorkStealingDequeTests, TestStealIsFirstInFirstOut) {
+    WorkStealingDeque deque;
+    deque.reserve(4);
+    deque.push(1);
+    deque.push(2);
+    deque.push(3);
+    ASSERT_EQ(deque.steal(), 1);
+    ASSERT_EQ(deque.take(), 3);
+    ASSERT_EQ(deque.steal(), 2);
+    ASSERT_EQ(deque.steal(), WorkStealingDeque::EMPTY);
+}
+
+TEST(WorkStealingDequeTests, TestReset) {
+    WorkStealingDeque deque;
+    deque.reserve(2);
+    deque.push(1);
+    deque.push(2);
+    deque.reset();
+    ASSERT_EQ(deque.take(), WorkStealingDeque::EMPTY);
+    deque.push(3);
+    deque.push(4);
+    ASSERT_EQ(deque.take(), 4);
+}
+
+TEST(WorkStealingDequeTests, TestEveryIdIsTakenOnceWithThieves) {
+    const uint32_t count = 100000;
+    const uint32_t thief_count = 3;
+    WorkStealingDeque deque;
+    deque.reserve(count);
+
+    unique_ptr<atomic<uint32_t>[]> taken(new atomic<uint32_t>[count]);
+    for (uint32_t i = 0; i < count; ++i) {
+        taken[i] = 0;
+    }
+    atomic<bool> is_done(false);
+
+    vector<thread> thieves;
+    for (uint32_t i = 0; i < thief_count; ++i) {
+        thieves.emplace_back([&]{
+            while (!is_done) {
+                uint32_t id = deque.steal();
+                if (id != WorkStealingDeque::EMPTY) {
+                    ++taken[id];
+                }
+            }
+        });
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        deque.push(i);
+        if (i % 3 == 0) {
+            uint32_t id = deque.take();
+            if (id != WorkStealingDeque::EMPTY) {
+                ++taken[id];
+            }
+        }
+    }
+    uint32_t id;
+    while ((id = deque.take()) != WorkStealingDeque::EMPTY) {
+        ++taken[id];
+    }
+
+    is_done = true;
+    for (thread &thief : thieves) {
+        thief.join();
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        ASSERT_EQ(taken[i], 1);
+    }
+}
@@ -5,6 +5,10 @@
 namespace soundstone_test {
     class MockSampler : public soundstone::Module {
     public:
+        static const uint32_t INPUT_COUNT = 2;
+
+        uint32_t input_count() const override { return INPUT_COUNT; }
+
         MOCK_METHOD0(commit, void());
         MOCK_METHOD3(sample, void(
             const float * const *input_buffers,
@@ -0,0 +1,33 @@
+#include "ChannelSampler.hpp"
+
+using namespace soundstone_test;
+
+ChannelSampler::ChannelSampler(uint32_t channel_count, uint32_t input_channel_count, float value)
+    : _channel_count(channel_count)
+    , _input_channel_count(input_channel_count)
+    , _value(value)
+{
+}
+
+uint32_t ChannelSampler::channel_count() const {
+    return _channel_count;
+}
+
+uint32_t ChannelSampler::input_channel_count(uint32_t index) const {
+    return _input_channel_count;
+}
+
+void ChannelSampler::commit() {}
+
+void ChannelSampler::sample(
+    const float * const *input_buffers,
+    float *output_buffer,
+    uint32_t nsamples
+) {
+    for (uint32_t channel = 0; channel < _channel_count; ++channel) {
+        for (uint32_t i = 0; i < nsamples; ++i) {
+            output_buffer[channel * nsamples + i] = _value + static_cast<float>(channel);
+        }
+    }
+    last_input.assign(input_buffers[0], input_buffers[0] + _input_channel_count * nsamples);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <soundstone/Module.hpp>
+#include <vector>
+
+namespace soundstone_test {
+    /**
+     * Outputs a constant for each channel, the first channel being value, the next value + 1 and so on, and keeps a
+     * copy of what it last read from its first input.
+     */
+    class ChannelSampler : public soundstone::Module {
+        uint32_t _channel_count;
+        uint32_t _input_channel_count;
+        float _value;
+
+    public:
+        std::vector<float> last_input;
+
+        ChannelSampler(uint32_t channel_count, uint32_t input_channel_count, float value);
+
+        uint32_t channel_count() const override;
+        uint32_t input_channel_count(uint32_t index) const override;
+        void commit() override;
+        void sample(
+            const float * const *input_data,
+            float *output_data,
+            uint32_t nsamples
+        ) override;
+    };
+}
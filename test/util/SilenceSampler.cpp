@@ -0,0 +1,39 @@
+#include "SilenceSampler.hpp"
+#include <algorithm>
+
+using namespace soundstone_test;
+using namespace std;
+
+SilenceSampler::SilenceSampler(bool preserves_silence)
+    : _preserves_silence(preserves_silence)
+{
+}
+
+bool SilenceSampler::preserves_silence() const {
+    return _preserves_silence;
+}
+
+void SilenceSampler::commit() {}
+
+void SilenceSampler::sample(
+    const float * const *input_data,
+    float *output_data,
+    uint32_t nsamples
+) {
+    bool silent_inputs[1] = {false};
+    sample_with_silence(input_data, silent_inputs, output_data, nsamples);
+}
+
+bool SilenceSampler::sample_with_silence(
+    const float * const *input_data,
+    const bool *silent_inputs,
+    float *output_data,
+    uint32_t nsamples
+) {
+    ++sample_count;
+    first_input_was_silent = silent_inputs[0];
+    last_input.assign(input_data[0], input_data[0] + nsamples);
+
+    fill_n(output_data, nsamples, is_silent ? 0.0f : value);
+    return is_silent;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <soundstone/Module.hpp>
+#include <vector>
+
+namespace soundstone_test {
+    /**
+     * Outputs either silence or a constant, and keeps track of how often it was sampled and what it last read from
+     * its first input.
+     */
+    class SilenceSampler : public soundstone::Module {
+        bool _preserves_silence;
+
+    public:
+        bool is_silent = false;
+        float value = 1.0f;
+
+        uint32_t sample_count = 0;
+        bool first_input_was_silent = false;
+        std::vector<float> last_input;
+
+        explicit SilenceSampler(bool preserves_silence);
+
+        bool preserves_silence() const override;
+        void commit() override;
+        void sample(
+            const float * const *input_data,
+            float *output_data,
+            uint32_t nsamples
+        ) override;
+        bool sample_with_silence(
+            const float * const *input_data,
+            const bool *silent_inputs,
+            float *output_data,
+            uint32_t nsamples
+        ) override;
+    };
+}
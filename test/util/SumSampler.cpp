@@ -0,0 +1,24 @@
+#include "SumSampler.hpp"
+#include <soundstone/simd/Kernels.hpp>
+
+using namespace soundstone;
+using namespace soundstone_test;
+
+SumSampler::SumSampler(uint32_t input_count)
+    : _input_count(input_count)
+{
+}
+
+uint32_t SumSampler::input_count() const {
+    return _input_count;
+}
+
+void SumSampler::commit() {}
+
+void SumSampler::sample(
+    const float * const *input_data,
+    float *output_data,
+    uint32_t nsamples
+) {
+    simd::sum(input_data, _input_count, output_data, nsamples);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <soundstone/Module.hpp>
+
+namespace soundstone_test {
+    /**
+     * Outputs the sum of all of its inputs.
+     */
+    class SumSampler : public soundstone::Module {
+        uint32_t _input_count;
+
+    public:
+        explicit SumSampler(uint32_t input_count);
+
+        uint32_t input_count() const override;
+        void commit() override;
+        void sample(
+            const float * const *input_data,
+            float *output_data,
+            uint32_t nsamples
+        ) override;
+    };
+}